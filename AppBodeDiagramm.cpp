@@ -1,4 +1,4 @@
-#include "ui_AppBodeDiagramm.h"
+﻿#include "ui_AppBodeDiagramm.h"
 #include "AppBodeDiagramm.h"
 #include <QVBoxLayout>
 #include <QGridLayout>
@@ -8,6 +8,11 @@
 #include "Orchestrator.h"
 #include <QPushButton>
 #include <QFileDialog>
+#include <QStatusBar>
+#include <QHeaderView>
+#include <QSignalBlocker>
+#include <QMessageBox>
+#include <QCheckBox>
 
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
@@ -15,21 +20,43 @@
 #include <QtCharts/QValueAxis>
 #include <QtCharts/QLogValueAxis>
 #include <cmath>
+#include <algorithm>
 
 AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
     : QMainWindow(parent), orchestratorRef(orchestrator), magnitudeChartView(nullptr)
 {
     // Create top-left widgets
+    systemList = new QListWidget(this);
+    systemList->setMaximumHeight(100);
+    addSystemButton = new QPushButton("Add System", this);
+    removeSystemButton = new QPushButton("Remove System", this);
     numeratorTextBox = new QLineEdit(this);
     denominatorTextBox = new QLineEdit(this);
     recognizedFunctionTextNominator = new QLabel("1", this);
     recognizedFunctionTextDivider = new QLabel("-", this);
     recognizedFunctionTextDenominator = new QLabel("1", this);
+    startFrequencyTextBox = new QLineEdit(this);
+    startFrequencyTextBox->setPlaceholderText("auto");
+    endFrequencyTextBox = new QLineEdit(this);
+    endFrequencyTextBox->setPlaceholderText("auto");
+    pointsPerDecadeTextBox = new QLineEdit(this);
+    pointsPerDecadeTextBox->setPlaceholderText("auto");
+    frequencyRangeInfoLabel = new QLabel("-", this);
+    impulseResponseCheckBox = new QCheckBox("Show impulse response instead of step response", this);
     exportButton = new QPushButton("Export Bode Diagrams", this);
+    exportTraceButton = new QPushButton("Export Timing Trace", this);
+    saveSessionButton = new QPushButton("Save Session", this);
+    openSessionButton = new QPushButton("Open Session", this);
 
     // Top-left layout for existing widgets
     QVBoxLayout* topLeftLayout = new QVBoxLayout();
-    topLeftLayout->addWidget(new QLabel("Polynomial Transfer function:", this));
+    QHBoxLayout* systemButtonLayout = new QHBoxLayout();
+    systemButtonLayout->addWidget(addSystemButton);
+    systemButtonLayout->addWidget(removeSystemButton);
+    topLeftLayout->addWidget(new QLabel("Systems (checked systems are overlaid):", this));
+    topLeftLayout->addWidget(systemList);
+    topLeftLayout->addLayout(systemButtonLayout);
+    topLeftLayout->addWidget(new QLabel("Polynomial Transfer function of the selected system:", this));
     topLeftLayout->addWidget(new QLabel("Numerator coefficients", this));
     topLeftLayout->addWidget(numeratorTextBox);
     topLeftLayout->addWidget(new QLabel("Denominator coefficients", this));
@@ -38,7 +65,25 @@ AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
     topLeftLayout->addWidget(recognizedFunctionTextNominator);
     topLeftLayout->addWidget(recognizedFunctionTextDivider);
     topLeftLayout->addWidget(recognizedFunctionTextDenominator);
+
+    // Frequency range in one row: start, end, points per decade
+    QGridLayout* frequencyRangeLayout = new QGridLayout();
+    frequencyRangeLayout->addWidget(new QLabel("Start frequency (rad/s)", this), 0, 0);
+    frequencyRangeLayout->addWidget(new QLabel("End frequency (rad/s)", this), 0, 1);
+    frequencyRangeLayout->addWidget(new QLabel("Points per decade", this), 0, 2);
+    frequencyRangeLayout->addWidget(startFrequencyTextBox, 1, 0);
+    frequencyRangeLayout->addWidget(endFrequencyTextBox, 1, 1);
+    frequencyRangeLayout->addWidget(pointsPerDecadeTextBox, 1, 2);
+    topLeftLayout->addLayout(frequencyRangeLayout);
+    topLeftLayout->addWidget(frequencyRangeInfoLabel);
+    topLeftLayout->addWidget(impulseResponseCheckBox);
     topLeftLayout->addWidget(exportButton); 
+    topLeftLayout->addWidget(exportTraceButton);
+
+    QHBoxLayout* sessionButtonLayout = new QHBoxLayout();
+    sessionButtonLayout->addWidget(saveSessionButton);
+    sessionButtonLayout->addWidget(openSessionButton);
+    topLeftLayout->addLayout(sessionButtonLayout);
 
     // Create bottom-left widgets
     infoTextWidget = new QLabel("If value can not be exactly calculated you will see an interval instead of a single value.", this);
@@ -46,6 +91,11 @@ AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
     phaseMarginLabel = new QLabel("Phase Margin: -", this);
     phaseCrossoverFrequencyLabel = new QLabel("Phase Crossover Frequency: -", this);
     gainCrossoverFrequencyLabel = new QLabel("Gain Crossover Frequency: -", this);
+    marginTable = new QTableWidget(0, 10, this);
+    marginTable->setHorizontalHeaderLabels({ "System", "AM", "PM", "PCF", "GCF", "Overshoot (%)", "Rise Time", "Settling Time", "Peak Time", "Final Value" });
+    marginTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    marginTable->verticalHeader()->setVisible(false);
+    marginTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     // Bottom-left layout for widgets
     QVBoxLayout* stabilityLayout = new QVBoxLayout();
@@ -53,6 +103,7 @@ AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
     stabilityLayout->addWidget(phaseMarginLabel);
     stabilityLayout->addWidget(phaseCrossoverFrequencyLabel);
     stabilityLayout->addWidget(gainCrossoverFrequencyLabel);
+    stabilityLayout->addWidget(marginTable);
     stabilityLayout->addWidget(infoTextWidget);
 
     QWidget* topLeftWidget = new QWidget(this);
@@ -66,19 +117,24 @@ AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
     // Top-right sector: Frequency response plot placeholder
     frequencyResponsePlot = new QWidget(this);
 
-    // Bottom-right sector: Phase response plot placeholder
+    // Middle-right sector: Phase response plot placeholder
     phaseResponsePlot = new QWidget(this);
 
-    // Main layout with grid (2x2 layout)
+    // Bottom-right sector: Step or impulse response plot placeholder
+    timeResponsePlot = new QWidget(this);
+
+    // Main layout with grid (plots on the right, the left bottom sector spans two rows)
     QGridLayout* mainLayout = new QGridLayout();
     mainLayout->addWidget(topLeftWidget, 0, 0);  // Top-left
-    mainLayout->addWidget(bottomLeftWidget, 1, 0);  // Bottom-left 
+    mainLayout->addWidget(bottomLeftWidget, 1, 0, 2, 1);  // Bottom-left 
     mainLayout->addWidget(frequencyResponsePlot, 0, 1);  // Top-right
-    mainLayout->addWidget(phaseResponsePlot, 1, 1);  // Bottom-right
+    mainLayout->addWidget(phaseResponsePlot, 1, 1);  // Middle-right
+    mainLayout->addWidget(timeResponsePlot, 2, 1);  // Bottom-right
 
-    // Set equal stretching for both rows and columns
-    mainLayout->setRowStretch(0, 1);  // Top row takes half the height
-    mainLayout->setRowStretch(1, 1);  // Bottom row takes half the height
+    // Set equal stretching for all rows and columns
+    mainLayout->setRowStretch(0, 1);  // Each row takes a third of the height
+    mainLayout->setRowStretch(1, 1);
+    mainLayout->setRowStretch(2, 1);
     mainLayout->setColumnStretch(0, 1);  // Left column takes half the width
     mainLayout->setColumnStretch(1, 1);  // Right column takes half the width
 
@@ -99,9 +155,45 @@ AppBodeDiagramm::AppBodeDiagramm(Orchestrator& orchestrator, QWidget* parent)
         orchestratorRef.updateRecognizedFunction();
         });
 
+    // Systems of the overlay
+    connect(addSystemButton, &QPushButton::clicked, this, [this]() {
+        orchestratorRef.addSystem();
+        });
+
+    connect(removeSystemButton, &QPushButton::clicked, this, [this]() {
+        orchestratorRef.removeSystem(systemList->currentRow());
+        });
+
+    connect(systemList, &QListWidget::currentRowChanged, this, [this](int row) {
+        orchestratorRef.selectSystem(row);
+        });
+
+    connect(systemList, &QListWidget::itemChanged, this, [this](QListWidgetItem* item) {
+        orchestratorRef.setSystemVisible(systemList->row(item), item->checkState() == Qt::Checked);
+        });
+
+    // Recalculate when the frequency range is changed
+    for (QLineEdit* rangeTextBox : { startFrequencyTextBox, endFrequencyTextBox, pointsPerDecadeTextBox }) {
+        connect(rangeTextBox, &QLineEdit::textChanged, this, [this]() {
+            orchestratorRef.updateRecognizedFunction();
+            });
+    }
+
+    // Switch the time response plot, the results are cached
+    connect(impulseResponseCheckBox, &QCheckBox::toggled, this, [this]() {
+        orchestratorRef.updateRecognizedFunction();
+        });
+
     // Export Picture
     connect(exportButton, &QPushButton::clicked, this, &AppBodeDiagramm::ExportBodeDiagrams);
 
+    // Export Chrome trace of the pipeline timings
+    connect(exportTraceButton, &QPushButton::clicked, this, &AppBodeDiagramm::ExportTimingTrace);
+
+    // Session files
+    connect(saveSessionButton, &QPushButton::clicked, this, &AppBodeDiagramm::SaveSession);
+    connect(openSessionButton, &QPushButton::clicked, this, &AppBodeDiagramm::OpenSession);
+
 }
 
 std::string AppBodeDiagramm::GetNumeratorBoxValue()
@@ -122,6 +214,63 @@ std::string AppBodeDiagramm::GetDenominatorBoxValue()
     return qstr.toStdString();
 }
 
+std::string AppBodeDiagramm::GetStartFrequencyBoxValue()
+{
+    return startFrequencyTextBox->text().toStdString();
+}
+
+std::string AppBodeDiagramm::GetEndFrequencyBoxValue()
+{
+    return endFrequencyTextBox->text().toStdString();
+}
+
+std::string AppBodeDiagramm::GetPointsPerDecadeBoxValue()
+{
+    return pointsPerDecadeTextBox->text().toStdString();
+}
+
+bool AppBodeDiagramm::GetImpulseResponseBoxValue()
+{
+    return impulseResponseCheckBox->isChecked();
+}
+
+void AppBodeDiagramm::SetNumeratorBoxValue(const std::string& value)
+{
+    // No textChanged signal, the orchestrator updates on its own
+    QSignalBlocker blocker(numeratorTextBox);
+    numeratorTextBox->setText(QString::fromStdString(value));
+}
+
+void AppBodeDiagramm::SetDenominatorBoxValue(const std::string& value)
+{
+    QSignalBlocker blocker(denominatorTextBox);
+    denominatorTextBox->setText(QString::fromStdString(value));
+}
+
+void AppBodeDiagramm::SetSystemList(const std::vector<std::string>& names, const std::vector<bool>& visible, int selected)
+{
+    QSignalBlocker blocker(systemList);
+    systemList->clear();
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        auto item = new QListWidgetItem(QString::fromStdString(names[i]), systemList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(visible[i] ? Qt::Checked : Qt::Unchecked);
+    }
+
+    systemList->setCurrentRow(selected);
+}
+
+void AppBodeDiagramm::SetFrequencyRangeBoxValues(const std::string& start, const std::string& end, const std::string& pointsPerDecade)
+{
+    QSignalBlocker startBlocker(startFrequencyTextBox);
+    QSignalBlocker endBlocker(endFrequencyTextBox);
+    QSignalBlocker pointsBlocker(pointsPerDecadeTextBox);
+    startFrequencyTextBox->setText(QString::fromStdString(start));
+    endFrequencyTextBox->setText(QString::fromStdString(end));
+    pointsPerDecadeTextBox->setText(QString::fromStdString(pointsPerDecade));
+}
+
 void AppBodeDiagramm::SetRecognizedFunctionNominator(const std::string& recognizedNumerator)
 {
     QString qstr = QString::fromStdString(recognizedNumerator);
@@ -140,43 +289,80 @@ void AppBodeDiagramm::SetDivider(const std::string& dividor)
     recognizedFunctionTextDivider->setText(qstr);
 }
 
-void AppBodeDiagramm::CreateMagnitudePlot(const std::vector<double>& frequencies, const std::vector<double>& magnitudes)
+void AppBodeDiagramm::SetFrequencyRangeInfo(double start, double end, int pointsPerDecade, const std::string& note)
 {
-
-    // Create a new QLineSeries to represent the magnitude plot
-    auto series = new QLineSeries();
-    for (size_t i = 0; i < frequencies.size(); ++i) {
-        if (frequencies[i] <= 0) {
-            continue; // Skip invalid frequency values for log10
-        }
-        series->append(frequencies[i], magnitudes[i]);
-
+    QString qstr = QString("Used range: %1 to %2 rad/s, %3 points per decade")
+        .arg(start, 0, 'g')
+        .arg(end, 0, 'g')
+        .arg(pointsPerDecade);
+    if (!note.empty()) {
+        qstr += QString(" (%1)").arg(QString::fromStdString(note));
     }
+    frequencyRangeInfoLabel->setText(qstr);
+}
 
-    // Create a new chart and add the series to it
+QChart* AppBodeDiagramm::CreateBodeChart(const QString& title, const QString& axisTitle, double start, double end, const std::vector<std::string>& names,
+    const std::vector<const std::vector<double>*>& frequencies, const std::vector<const std::vector<double>*>& values)
+{
+    // Create a new chart, one QLineSeries per system
     auto chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle("Magnitude Plot");
+    chart->setTitle(title);
 
     auto logAxisX = new QLogValueAxis();
     logAxisX->setTitleText("Frequency (log10 scale)");
     logAxisX->setBase(10);  // Base 10 for logarithmic scale
     logAxisX->setLabelFormat("%g");
-    logAxisX->setMinorTickCount(9); 
+    logAxisX->setMinorTickCount(9);
+    logAxisX->setRange(start, end);
     chart->addAxis(logAxisX, Qt::AlignBottom);
-    series->attachAxis(logAxisX);
 
     auto axisY = new QValueAxis();
-    axisY->setTitleText("Magnitude (dB)");
+    axisY->setTitleText(axisTitle);
     axisY->setLabelFormat("%.1f");
-    auto minMagnitude = *std::min_element(magnitudes.begin(), magnitudes.end());
-    auto maxMagnitude = *std::max_element(magnitudes.begin(), magnitudes.end());
+    chart->addAxis(axisY, Qt::AlignLeft);
+
+    double minValue = 0.0;
+    double maxValue = 0.0;
+    bool hasValues = false;
+
+    for (size_t s = 0; s < values.size(); ++s) {
+        const std::vector<double>& seriesFrequencies = *frequencies[s];
+        const std::vector<double>& seriesValues = *values[s];
+
+        // Reused results may cover a wider range than the shown one
+        auto series = new QLineSeries();
+        series->setName(QString::fromStdString(names[s]));
+        for (size_t i = 0; i < seriesFrequencies.size() && i < seriesValues.size(); ++i) {
+            if (seriesFrequencies[i] < start || seriesFrequencies[i] > end) {
+                continue;
+            }
+            series->append(seriesFrequencies[i], seriesValues[i]);
+
+            if (std::isfinite(seriesValues[i])) {
+                minValue = hasValues ? std::min(minValue, seriesValues[i]) : seriesValues[i];
+                maxValue = hasValues ? std::max(maxValue, seriesValues[i]) : seriesValues[i];
+                hasValues = true;
+            }
+        }
+
+        chart->addSeries(series);
+        series->attachAxis(logAxisX);
+        series->attachAxis(axisY);
+    }
 
     // Add space to make sure data is always visible.
-    axisY->setRange(minMagnitude - 20, maxMagnitude + 20);
+    axisY->setRange(minValue - 20, maxValue + 20);
 
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
+    // A legend is only useful when systems are overlaid
+    chart->legend()->setVisible(values.size() > 1);
+
+    return chart;
+}
+
+void AppBodeDiagramm::CreateMagnitudePlot(double start, double end, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& frequencies,
+    const std::vector<const std::vector<double>*>& magnitudes)
+{
+    auto chart = CreateBodeChart("Magnitude Plot", "Magnitude (dB)", start, end, names, frequencies, magnitudes);
 
     // Create a new chart view to display the chart
     if (magnitudeChartView) {
@@ -192,38 +378,10 @@ void AppBodeDiagramm::CreateMagnitudePlot(const std::vector<double>& frequencies
     frequencyResponsePlot->setLayout(layout);
 }
 
-void AppBodeDiagramm::CreatePhasePlot(const std::vector<double>& frequencies, const std::vector<double>& phases)
+void AppBodeDiagramm::CreatePhasePlot(double start, double end, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& frequencies,
+    const std::vector<const std::vector<double>*>& phases)
 {
-    // Create a new QLineSeries to represent the phase plot
-    auto series = new QLineSeries();
-    for (size_t i = 0; i < frequencies.size(); ++i) {
-        if (frequencies[i] <= 0) {
-            continue; // Skip invalid frequency values for log10
-        }
-        series->append(frequencies[i], phases[i]);
-    }
-
-    // Create a new chart and add the series to it
-    auto chart = new QChart();
-    chart->addSeries(series);
-    chart->setTitle("Phase Plot");
-
-    auto logAxisX = new QLogValueAxis();
-    logAxisX->setTitleText("Frequency (log10 scale)");
-    logAxisX->setBase(10);  // Base 10 for logarithmic scale
-    logAxisX->setLabelFormat("%g");  
-    logAxisX->setMinorTickCount(9);
-    chart->addAxis(logAxisX, Qt::AlignBottom);
-    series->attachAxis(logAxisX);
-
-    auto axisY = new QValueAxis();
-    axisY->setTitleText("Phase (degrees)");
-    axisY->setLabelFormat("%.1f");
-    chart->addAxis(axisY, Qt::AlignLeft);
-    series->attachAxis(axisY);
-    auto minPhase = *std::min_element(phases.begin(), phases.end());
-    auto maxPhase = *std::max_element(phases.begin(), phases.end());
-    axisY->setRange(minPhase - 20, maxPhase + 20);
+    auto chart = CreateBodeChart("Phase Plot", "Phase (degrees)", start, end, names, frequencies, phases);
 
     // Create a new chart view to display the chart
     auto phaseChartView = new QChartView(chart);
@@ -236,6 +394,68 @@ void AppBodeDiagramm::CreatePhasePlot(const std::vector<double>& frequencies, co
     phaseResponsePlot->setLayout(layout);
 }
 
+void AppBodeDiagramm::CreateTimeResponsePlot(const std::string& title, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& times,
+    const std::vector<const std::vector<double>*>& values)
+{
+    // Create a new chart, one QLineSeries per system on a linear time axis
+    auto chart = new QChart();
+    chart->setTitle(QString::fromStdString(title));
+
+    auto axisX = new QValueAxis();
+    axisX->setTitleText("Time (s)");
+    axisX->setLabelFormat("%g");
+    chart->addAxis(axisX, Qt::AlignBottom);
+
+    auto axisY = new QValueAxis();
+    axisY->setTitleText("Output");
+    axisY->setLabelFormat("%.2f");
+    chart->addAxis(axisY, Qt::AlignLeft);
+
+    double endTime = 0.0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+
+    for (size_t s = 0; s < values.size(); ++s) {
+        const std::vector<double>& seriesTimes = *times[s];
+        const std::vector<double>& seriesValues = *values[s];
+
+        auto series = new QLineSeries();
+        series->setName(QString::fromStdString(names[s]));
+        for (size_t i = 0; i < seriesTimes.size() && i < seriesValues.size(); ++i) {
+            if (!std::isfinite(seriesValues[i])) {
+                break; // Unstable systems overflow at some point
+            }
+            series->append(seriesTimes[i], seriesValues[i]);
+            minValue = std::min(minValue, seriesValues[i]);
+            maxValue = std::max(maxValue, seriesValues[i]);
+        }
+        if (!seriesTimes.empty()) {
+            endTime = std::max(endTime, seriesTimes.back());
+        }
+
+        chart->addSeries(series);
+        series->attachAxis(axisX);
+        series->attachAxis(axisY);
+    }
+
+    // Zero is always included, 10 % space above and below keeps the curves off the border
+    double padding = std::max(0.1 * (maxValue - minValue), 1e-3);
+    axisX->setRange(0.0, endTime > 0.0 ? endTime : 1.0);
+    axisY->setRange(minValue - padding, maxValue + padding);
+
+    // A legend is only useful when systems are overlaid
+    chart->legend()->setVisible(values.size() > 1);
+
+    auto timeChartView = new QChartView(chart);
+    timeChartView->setRenderHint(QPainter::Antialiasing);
+
+    // Replace the existing time response plot widget with the new chart view
+    auto layout = new QVBoxLayout();
+    layout->addWidget(timeChartView);
+    delete timeResponsePlot->layout();
+    timeResponsePlot->setLayout(layout);
+}
+
 void AppBodeDiagramm::UpdateAmplitudeMargin(const std::string& value) {
     amplitudeMarginLabel->setText(QString::fromStdString("Amplitude Margin (AM): " + value));
 }
@@ -252,6 +472,20 @@ void AppBodeDiagramm::UpdateGainCrossoverFrequency(const std::string& value) {
     gainCrossoverFrequencyLabel->setText(QString::fromStdString("Gain Crossover Frequency (GCF): " + value));
 }
 
+void AppBodeDiagramm::UpdateMarginTable(const std::vector<std::vector<std::string>>& rows) {
+    marginTable->setRowCount(static_cast<int>(rows.size()));
+
+    for (size_t row = 0; row < rows.size(); ++row) {
+        for (size_t column = 0; column < rows[row].size(); ++column) {
+            marginTable->setItem(static_cast<int>(row), static_cast<int>(column), new QTableWidgetItem(QString::fromStdString(rows[row][column])));
+        }
+    }
+}
+
+void AppBodeDiagramm::UpdateTimingInfo(const std::string& value) {
+    statusBar()->showMessage(QString::fromStdString(value));
+}
+
 void AppBodeDiagramm::ExportBodeDiagrams()
 {
     QString filePath = QFileDialog::getSaveFileName(this, "Save Bode Diagrams", "", "PNG Files (*.png);;All Files (*)");
@@ -275,6 +509,54 @@ void AppBodeDiagramm::ExportBodeDiagrams()
             phasePixmap.save(filePath + "-phase.png");
         }
     }
+
+    // Step or impulse response diagram, whichever is shown
+    if (timeResponsePlot && timeResponsePlot->layout()) {
+        QChartView* timeChartView = dynamic_cast<QChartView*>(timeResponsePlot->layout()->itemAt(0)->widget());
+        if (timeChartView) {
+            QPixmap timePixmap = timeChartView->grab();
+            timePixmap.save(filePath + (impulseResponseCheckBox->isChecked() ? "-impulse.png" : "-step.png"));
+        }
+    }
+}
+
+void AppBodeDiagramm::ExportTimingTrace()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "Save Timing Trace", "", "Trace Files (*.json);;All Files (*)");
+
+    if (filePath.isEmpty()) {
+        return; // Cancel if no filename was specified.
+    }
+
+    if (!orchestratorRef.exportTimingTrace(filePath.toStdString())) {
+        QMessageBox::warning(this, "Export Timing Trace", "The trace file could not be written.");
+    }
 }
 
+void AppBodeDiagramm::SaveSession()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "Save Session", "", "Bode Sessions (*.bode);;All Files (*)");
+
+    if (filePath.isEmpty()) {
+        return; // Cancel if no filename was specified.
+    }
+
+    std::string errorMessage;
+    if (!orchestratorRef.saveSession(filePath.toStdString(), errorMessage)) {
+        QMessageBox::warning(this, "Save Session", QString::fromStdString(errorMessage));
+    }
+}
 
+void AppBodeDiagramm::OpenSession()
+{
+    QString filePath = QFileDialog::getOpenFileName(this, "Open Session", "", "Bode Sessions (*.bode);;All Files (*)");
+
+    if (filePath.isEmpty()) {
+        return; // Cancel if no filename was specified.
+    }
+
+    std::string errorMessage;
+    if (!orchestratorRef.loadSession(filePath.toStdString(), errorMessage)) {
+        QMessageBox::warning(this, "Open Session", QString::fromStdString(errorMessage));
+    }
+}
@@ -7,7 +7,11 @@
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QWidget>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QCheckBox>
 #include <QtCharts/QChartView>
+#include <string>
 #include <vector>
 
 class Orchestrator;
@@ -21,13 +25,35 @@ public:
 
     std::string GetNumeratorBoxValue();
     std::string GetDenominatorBoxValue();
+    void SetNumeratorBoxValue(const std::string& value);
+    void SetDenominatorBoxValue(const std::string& value);
+
+    // Rebuilds the list of overlaid systems
+    void SetSystemList(const std::vector<std::string>& names, const std::vector<bool>& visible, int selected);
+
+    // Frequency range overrides, empty string means automatic
+    std::string GetStartFrequencyBoxValue();
+    std::string GetEndFrequencyBoxValue();
+    std::string GetPointsPerDecadeBoxValue();
+    bool GetImpulseResponseBoxValue();
+    void SetFrequencyRangeBoxValues(const std::string& start, const std::string& end, const std::string& pointsPerDecade);
 
     void SetRecognizedFunctionNominator(const std::string& recognizedNumerator);
     void SetRecognizedFunctionDenominator(const std::string& recognizedDenominator);
     void SetDivider(const std::string& dividor);
-    void CreateMagnitudePlot(const std::vector<double>& frequencies, const std::vector<double>& magnitudes);
-    void CreatePhasePlot(const std::vector<double>& frequencies, const std::vector<double>& phases);
+    void SetFrequencyRangeInfo(double start, double end, int pointsPerDecade, const std::string& note);
+    // One series per system on its own frequencies, only the part from start to end is shown
+    void CreateMagnitudePlot(double start, double end, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& frequencies,
+        const std::vector<const std::vector<double>*>& magnitudes);
+    void CreatePhasePlot(double start, double end, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& frequencies,
+        const std::vector<const std::vector<double>*>& phases);
+    // One series per system, every system has its own time axis. Shows the step or the impulse response.
+    void CreateTimeResponsePlot(const std::string& title, const std::vector<std::string>& names, const std::vector<const std::vector<double>*>& times,
+        const std::vector<const std::vector<double>*>& values);
     void ExportBodeDiagrams();
+    void ExportTimingTrace();
+    void SaveSession();
+    void OpenSession();
 
     // Methods to update Stability Analysis values
     void UpdateAmplitudeMargin(const std::string& value);
@@ -35,15 +61,36 @@ public:
     void UpdatePhaseCrossoverFrequency(const std::string& value);
     void UpdateGainCrossoverFrequency(const std::string& value);
 
+    // One row per visible system: name, AM, PM, PCF, GCF, overshoot, rise time, settling time, peak time, final value
+    void UpdateMarginTable(const std::vector<std::vector<std::string>>& rows);
+
+    // Shows the timing breakdown of the last update in the status bar
+    void UpdateTimingInfo(const std::string& value);
+
 
 private:
+    // Creates a chart with one line series per system on a logarithmic frequency axis
+    QChart* CreateBodeChart(const QString& title, const QString& axisTitle, double start, double end, const std::vector<std::string>& names,
+        const std::vector<const std::vector<double>*>& frequencies, const std::vector<const std::vector<double>*>& values);
+
     // Widgets for the top-left sector
+    QListWidget* systemList;
+    QPushButton* addSystemButton;
+    QPushButton* removeSystemButton;
     QLineEdit* numeratorTextBox;
     QLineEdit* denominatorTextBox;
     QLabel* recognizedFunctionTextNominator;
     QLabel* recognizedFunctionTextDivider;
     QLabel* recognizedFunctionTextDenominator;
+    QLineEdit* startFrequencyTextBox;
+    QLineEdit* endFrequencyTextBox;
+    QLineEdit* pointsPerDecadeTextBox;
+    QLabel* frequencyRangeInfoLabel;
+    QCheckBox* impulseResponseCheckBox;
     QPushButton* exportButton;
+    QPushButton* exportTraceButton;
+    QPushButton* saveSessionButton;
+    QPushButton* openSessionButton;
 
     // Placeholder for bottom-left sector (add widgets later)
     QWidget* bottomLeftWidget;
@@ -51,6 +98,7 @@ private:
     // Widgets for plots (top-right and bottom-right sectors)
     QWidget* frequencyResponsePlot;
     QWidget* phaseResponsePlot;
+    QWidget* timeResponsePlot;
     QChartView* magnitudeChartView;
 
     QGridLayout* mainLayout;
@@ -63,6 +111,7 @@ private:
     QLabel* phaseMarginLabel;
     QLabel* phaseCrossoverFrequencyLabel;
     QLabel* gainCrossoverFrequencyLabel;
+    QTableWidget* marginTable;
 
    
 };
@@ -0,0 +1,356 @@
+#include "ComputeServer.h"
+#include "Json.h"
+#include "LocalSocket.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+// WorkerPool class implementation
+WorkerPool::WorkerPool(unsigned int threadCount, size_t maxQueuedTasks)
+    : maxQueuedTasks(maxQueuedTasks) {
+    for (unsigned int i = 0; i < std::max(1u, threadCount); ++i) {
+        threads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceAvailable.wait(lock, [this]() { return tasks.size() < maxQueuedTasks; });
+    tasks.push_back(std::move(task));
+    lock.unlock();
+
+    taskAvailable.notify_one();
+}
+
+void WorkerPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return tasks.empty() && activeTasks == 0; });
+}
+
+void WorkerPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;   // stopping and nothing left to do
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            ++activeTasks;
+        }
+        spaceAvailable.notify_one();
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeTasks;
+        }
+        idle.notify_all();
+    }
+}
+
+// ComputeServer class implementation
+ComputeServer::ComputeServer(unsigned int threadCount)
+    : pool(threadCount, 4 * std::max(1u, threadCount)) {}
+
+std::shared_ptr<const std::vector<double>> ComputeServer::getFrequencies(const FrequencyGrid& grid) {
+    auto key = std::make_tuple(grid.getStartFrequency(), grid.getEndFrequency(), grid.getPointsPerDecade());
+
+    {
+        std::lock_guard<std::mutex> lock(gridCacheMutex);
+        auto cached = gridCache.find(key);
+        if (cached != gridCache.end()) {
+            return cached->second;
+        }
+    }
+
+    // Created outside the lock, two threads may create the same grid once
+    auto frequencies = std::make_shared<const std::vector<double>>(grid.createFrequencies());
+
+    std::lock_guard<std::mutex> lock(gridCacheMutex);
+    if (gridCache.size() >= maxCachedGrids) {
+        gridCache.erase(gridCache.begin());
+    }
+    gridCache.emplace(key, frequencies);
+    return frequencies;
+}
+
+// Reads one line like std::getline, but keeps at most maxLength + 1 characters. The rest of a
+// longer line is consumed and dropped, the caller recognizes it by its length.
+static bool readBoundedLine(std::istream& input, std::string& line, size_t maxLength)
+{
+    line.clear();
+    std::streambuf* buffer = input.rdbuf();
+    bool any = false;
+    for (int c = buffer->sbumpc(); c != std::char_traits<char>::eof(); c = buffer->sbumpc()) {
+        any = true;
+        if (c == '\n') {
+            return true;
+        }
+        if (line.size() <= maxLength) {
+            line += static_cast<char>(c);
+        }
+    }
+    input.setstate(std::ios::eofbit);
+    return any;
+}
+
+// Coefficients must be finite, strtod accepts nan, inf and 1e999
+static void checkCoefficients(const std::vector<double>& coefficients, const char* name)
+{
+    if (coefficients.size() > ComputeServer::maxOrder + 1) {
+        throw std::runtime_error(std::string(name) + " order is above " + std::to_string(ComputeServer::maxOrder));
+    }
+    for (double value : coefficients) {
+        if (!std::isfinite(value)) {
+            throw std::runtime_error(std::string(name) + " coefficients must be finite");
+        }
+    }
+}
+
+// Copies the request id (number or string) into the response
+static void appendId(std::string& output, const JsonValue* id)
+{
+    output += "{\"id\":";
+    if (id && id->isNumber()) {
+        appendJsonNumber(output, id->asNumber());
+    }
+    else if (id && id->getType() == JsonValue::Type::String) {
+        appendJsonString(output, id->asString());
+    }
+    else {
+        output += "null";
+    }
+}
+
+std::string ComputeServer::handleRequest(const std::string& line) {
+    ScopedTimer timer("Request");
+
+    std::string response;
+    const JsonValue* id = nullptr;
+    JsonValue request;
+
+    try
+    {
+        if (line.size() > maxLineLength) {
+            throw std::runtime_error("Request line is longer than " + std::to_string(maxLineLength) + " bytes");
+        }
+        request = JsonValue::parse(line);
+        if (!request.isObject()) {
+            throw std::runtime_error("Request must be a JSON object");
+        }
+        id = request.find("id");
+
+        const JsonValue* numeratorValue = request.find("numerator");
+        const JsonValue* denominatorValue = request.find("denominator");
+        if (!numeratorValue || !denominatorValue) {
+            throw std::runtime_error("Request needs \"numerator\" and \"denominator\"");
+        }
+
+        std::vector<double> numerator = numeratorValue->asNumberArray();
+        std::vector<double> denominator = denominatorValue->asNumberArray();
+        checkCoefficients(numerator, "Numerator");
+        checkCoefficients(denominator, "Denominator");
+        if (numerator.empty() || std::all_of(denominator.begin(), denominator.end(), [](double value) { return value == 0.0; })) {
+            throw std::runtime_error("Numerator must not be empty and denominator must not be zero");
+        }
+
+        TransferFunction transferFunction(numerator, denominator);
+
+        // Optional loop closure with a sensor H: G / (1 + G H), or G / (1 - G H) with "positive"
+        if (const JsonValue* feedbackValue = request.find("feedback")) {
+            std::vector<double> sensorNumerator = { 1.0 };
+            std::vector<double> sensorDenominator = { 1.0 };
+            bool positive = false;
+            if (const JsonValue* value = feedbackValue->find("numerator")) {
+                sensorNumerator = value->asNumberArray();
+            }
+            if (const JsonValue* value = feedbackValue->find("denominator")) {
+                sensorDenominator = value->asNumberArray();
+            }
+            if (const JsonValue* value = feedbackValue->find("positive")) {
+                positive = value->asBool();
+            }
+            checkCoefficients(sensorNumerator, "Feedback numerator");
+            checkCoefficients(sensorDenominator, "Feedback denominator");
+            if (sensorNumerator.empty() || std::all_of(sensorDenominator.begin(), sensorDenominator.end(), [](double value) { return value == 0.0; })) {
+                throw std::runtime_error("Feedback numerator must not be empty and denominator must not be zero");
+            }
+
+            transferFunction = TransferFunction::feedback(transferFunction, TransferFunction(sensorNumerator, sensorDenominator),
+                positive, TransferFunction::Composition::Factored);
+        }
+
+        // Automatic grid, single values can be overridden by the request like in the GUI
+        FrequencyGrid automaticGrid = FrequencyGrid::fromTransferFunction(transferFunction);
+        double userStart = 0.0;
+        double userEnd = 0.0;
+        double pointsPerDecade = automaticGrid.getPointsPerDecade();
+        if (const JsonValue* gridValue = request.find("grid")) {
+            if (!gridValue->isObject()) {
+                throw std::runtime_error("Grid must be an object");
+            }
+            if (const JsonValue* value = gridValue->find("start")) {
+                userStart = value->asNumber();
+                if (!(userStart > 0.0)) {
+                    throw std::runtime_error("Invalid grid");
+                }
+            }
+            if (const JsonValue* value = gridValue->find("end")) {
+                userEnd = value->asNumber();
+                if (!(userEnd > 0.0)) {
+                    throw std::runtime_error("Invalid grid");
+                }
+            }
+            if (const JsonValue* value = gridValue->find("pointsPerDecade")) {
+                pointsPerDecade = value->asNumber();
+            }
+        }
+        if (!(pointsPerDecade >= 1.0) || pointsPerDecade > 100000.0) {
+            throw std::runtime_error("Invalid grid");
+        }
+
+        std::string rangeNote;
+        FrequencyGrid boundedGrid = automaticGrid.withBounds(userStart, userEnd, rangeNote);
+        double start = boundedGrid.getStartFrequency();
+        double end = boundedGrid.getEndFrequency();
+        if (!(end > start) || !std::isfinite(end)) {
+            throw std::runtime_error("Invalid grid");
+        }
+
+        // Limit the total amount of points like the automatic grid, the response reports the reduced value
+        double decades = std::log10(end) - std::log10(start);
+        if (decades * pointsPerDecade > maxGridPoints) {
+            pointsPerDecade = std::max(1.0, std::floor(maxGridPoints / decades));
+        }
+        FrequencyGrid grid(start, end, static_cast<int>(pointsPerDecade));
+
+        bool includeBode = true;
+        if (const JsonValue* bodeValue = request.find("bode")) {
+            includeBode = bodeValue->asBool();
+        }
+
+        FrequencyResponse frequencyResponse(getFrequencies(grid));
+        frequencyResponse.compute(transferFunction);
+
+        StabilityAnalyzer stabilityAnalyzer;
+        stabilityAnalyzer.analyze(transferFunction, frequencyResponse);
+
+        appendId(response, id);
+        response += ",\"grid\":{\"start\":";
+        appendJsonNumber(response, grid.getStartFrequency());
+        response += ",\"end\":";
+        appendJsonNumber(response, grid.getEndFrequency());
+        response += ",\"pointsPerDecade\":";
+        appendJsonNumber(response, grid.getPointsPerDecade());
+        if (!rangeNote.empty()) {
+            response += ",\"note\":";
+            appendJsonString(response, rangeNote);
+        }
+        response += "},\"margins\":{\"amplitudeMargin\":";
+        appendJsonString(response, stabilityAnalyzer.getAmplitudeMargin());
+        response += ",\"phaseMargin\":";
+        appendJsonString(response, stabilityAnalyzer.getPhaseMargin());
+        response += ",\"phaseCrossoverFrequency\":";
+        appendJsonString(response, stabilityAnalyzer.getPhaseCrossoverFrequency());
+        response += ",\"gainCrossoverFrequency\":";
+        appendJsonString(response, stabilityAnalyzer.getGainCrossoverFrequency());
+        response += "}";
+
+        if (includeBode) {
+            response += ",\"frequencies\":";
+            appendJsonNumberArray(response, frequencyResponse.getFrequencies());
+            response += ",\"magnitudes\":";
+            appendJsonNumberArray(response, frequencyResponse.getMagnitudes());
+            response += ",\"phases\":";
+            appendJsonNumberArray(response, frequencyResponse.getPhases());
+        }
+        response += "}";
+    }
+    catch (const std::exception& error)
+    {
+        response.clear();
+        appendId(response, id);
+        response += ",\"error\":";
+        appendJsonString(response, error.what());
+        response += "}";
+    }
+
+    return response;
+}
+
+void ComputeServer::serveStream(std::istream& input, std::ostream& output) {
+    std::mutex outputMutex;
+    std::string line;
+
+    while (readBoundedLine(input, line, maxLineLength)) {
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+
+        pool.submit([this, line, &output, &outputMutex]() {
+            std::string response = handleRequest(line);
+            response += '\n';
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            output << response << std::flush;
+            });
+    }
+
+    // Answer everything that is still queued before returning
+    pool.waitIdle();
+}
+
+// One client of the socket. Shared by its reader thread and its pending requests,
+// the socket is closed when the last of them is done.
+struct SocketConnection {
+    LocalSocket socket;
+    std::mutex writeMutex;
+};
+
+void ComputeServer::serveSocket(const std::string& path) {
+    LocalSocket listener = LocalSocket::listen(path);
+
+    while (true) {
+        auto connection = std::make_shared<SocketConnection>();
+        connection->socket = listener.accept();
+        if (!connection->socket.isValid()) {
+            continue;
+        }
+
+        // The reader only parses lines, the work is done by the pool
+        std::thread([this, connection]() {
+            std::string line;
+            while (connection->socket.readLine(line, maxLineLength)) {
+                if (line.empty() || line == "\r") {
+                    continue;
+                }
+
+                pool.submit([this, line, connection]() {
+                    std::string response = handleRequest(line);
+                    response += '\n';
+
+                    std::lock_guard<std::mutex> lock(connection->writeMutex);
+                    connection->socket.writeAll(response);
+                    });
+            }
+            }).detach();
+    }
+}
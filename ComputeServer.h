@@ -0,0 +1,86 @@
+#ifndef COMPUTESERVER_H
+#define COMPUTESERVER_H
+
+#include "FunctionalClasses.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// WorkerPool class
+// Fixed amount of threads working on a queue of tasks. submit() blocks while the queue is full,
+// so a client that pipelines many requests can not make the server buffer without limit.
+class WorkerPool {
+public:
+    WorkerPool(unsigned int threadCount, size_t maxQueuedTasks);
+    ~WorkerPool();
+
+    void submit(std::function<void()> task);
+
+    // Waits until the queue is empty and no task is running
+    void waitIdle();
+
+private:
+    void run();
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable spaceAvailable;
+    std::condition_variable idle;
+    size_t maxQueuedTasks;
+    size_t activeTasks = 0;
+    bool stopping = false;
+};
+
+// ComputeServer class
+// Answers JSON-lines requests with Bode data and stability margins. Requests are handled
+// concurrently, so responses can arrive in a different order than the requests; the "id"
+// of a request is copied into its response.
+//
+// Request:  {"id": 1, "numerator": [1], "denominator": [1, 2, 1],
+//            "grid": {"start": 0.01, "end": 100, "pointsPerDecade": 200}, "bode": true}
+//           "grid" and each of its members are optional (automatic range), "bode": false
+//           returns only the margins. Polynomials may have an order up to maxOrder, all
+//           coefficients must be finite and a request line may have up to maxLineLength bytes.
+// Response: {"id": 1, "grid": {...}, "margins": {...}, "frequencies": [...], "magnitudes": [...], "phases": [...]}
+//           or {"id": 1, "error": "..."}
+class ComputeServer {
+public:
+    explicit ComputeServer(unsigned int threadCount);
+
+    // Limits of a request. Root finding costs O(n^2) per iteration, a few requests of very high
+    // order would otherwise keep all workers busy for minutes.
+    static constexpr size_t maxOrder = 100;
+    static constexpr size_t maxLineLength = 1 << 20;
+
+    // Answers one request line (without '\n'). Thread safe.
+    std::string handleRequest(const std::string& line);
+
+    // Serves requests from 'input' until end of file
+    void serveStream(std::istream& input, std::ostream& output);
+
+    // Serves clients of a Unix domain socket at 'path', does not return
+    void serveSocket(const std::string& path);
+
+private:
+    // Frequency grids are shared between requests with the same grid settings
+    std::shared_ptr<const std::vector<double>> getFrequencies(const FrequencyGrid& grid);
+
+    WorkerPool pool;
+
+    std::mutex gridCacheMutex;
+    std::map<std::tuple<double, double, int>, std::shared_ptr<const std::vector<double>>> gridCache;
+    static const size_t maxCachedGrids = 64;
+    static constexpr double maxGridPoints = 200000.0;   // per request, pointsPerDecade is reduced above
+};
+
+#endif // COMPUTESERVER_H
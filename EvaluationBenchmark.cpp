@@ -0,0 +1,369 @@
+#include "FunctionalClasses.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Accuracy and speed of the frequency response evaluation. The reference evaluates the plain sum
+// of a_i (jw)^(n-i) in double-double arithmetic (about 32 digits) with a separate binary exponent,
+// so neither rounding nor the range of double limit it.
+
+static const double pi = 3.14159265358979323846;
+
+// DoubleDouble class
+// Unevaluated sum high + low with |low| <= ulp(high) / 2
+struct DoubleDouble {
+    double high = 0.0;
+    double low = 0.0;
+};
+
+static DoubleDouble twoSum(double a, double b)
+{
+    double sum = a + b;
+    double virtualB = sum - a;
+    double error = (a - (sum - virtualB)) + (b - virtualB);
+    return { sum, error };
+}
+
+static DoubleDouble addDoubleDouble(const DoubleDouble& a, const DoubleDouble& b)
+{
+    DoubleDouble sum = twoSum(a.high, b.high);
+    DoubleDouble lowSum = twoSum(a.low, b.low);
+    sum.low += lowSum.high;
+    sum = twoSum(sum.high, sum.low);
+    sum.low += lowSum.low;
+    return twoSum(sum.high, sum.low);
+}
+
+static DoubleDouble multiplyDoubleDouble(const DoubleDouble& a, const DoubleDouble& b)
+{
+    double product = a.high * b.high;
+    double error = std::fma(a.high, b.high, -product);
+    error += a.high * b.low + a.low * b.high;
+    return twoSum(product, error);
+}
+
+static DoubleDouble scaleDoubleDouble(const DoubleDouble& a, int shift)
+{
+    return { std::ldexp(a.high, shift), std::ldexp(a.low, shift) };
+}
+
+// Complex double-double value * 2^exponent
+struct ReferenceValue {
+    DoubleDouble real;
+    DoubleDouble imag;
+    long exponent = 0;
+};
+
+// Sum of a_i (jw)^(n-i), every term is formed separately
+static ReferenceValue evaluateReference(const std::vector<double>& coefficients, double frequency)
+{
+    struct Term {
+        DoubleDouble value;
+        long exponent;
+        size_t power;
+    };
+    std::vector<Term> terms;
+
+    // |w|^k as double-double with exponent, renormalized after every multiplication
+    DoubleDouble magnitude = { std::abs(frequency), 0.0 };
+    DoubleDouble power = { 1.0, 0.0 };
+    long powerExponent = 0;
+    for (size_t k = 0; k < coefficients.size(); ++k) {
+        double coefficient = coefficients[coefficients.size() - 1 - k];
+        if (coefficient != 0.0) {
+            terms.push_back({ multiplyDoubleDouble(power, { coefficient, 0.0 }), powerExponent, k });
+        }
+
+        power = multiplyDoubleDouble(power, magnitude);
+        int shift = 0;
+        std::frexp(power.high, &shift);
+        power = scaleDoubleDouble(power, -shift);
+        powerExponent += shift;
+    }
+
+    ReferenceValue result;
+    if (terms.empty()) {
+        return result;
+    }
+
+    long largest = terms[0].exponent;
+    for (const auto& term : terms) {
+        largest = std::max(largest, term.exponent);
+    }
+    result.exponent = largest;
+
+    // j^k rotates the term, (-1)^k for negative frequencies
+    for (const auto& term : terms) {
+        DoubleDouble value = scaleDoubleDouble(term.value, static_cast<int>(std::max(term.exponent - largest, -2000L)));
+        if (frequency < 0.0 && term.power % 2 == 1) {
+            value = { -value.high, -value.low };
+        }
+        DoubleDouble negative = { -value.high, -value.low };
+
+        switch (term.power % 4) {
+        case 0: result.real = addDoubleDouble(result.real, value); break;
+        case 1: result.imag = addDoubleDouble(result.imag, value); break;
+        case 2: result.real = addDoubleDouble(result.real, negative); break;
+        default: result.imag = addDoubleDouble(result.imag, negative); break;
+        }
+    }
+    return result;
+}
+
+// Magnitude (dB) and phase (degree) of numerator / denominator from the reference values
+static void referenceResponse(const ReferenceValue& numerator, const ReferenceValue& denominator, double& magnitude, double& phase)
+{
+    // The sums are exact to about 32 digits, double is enough for the ratio
+    double nr = numerator.real.high + numerator.real.low;
+    double ni = numerator.imag.high + numerator.imag.low;
+    double dr = denominator.real.high + denominator.real.low;
+    double di = denominator.imag.high + denominator.imag.low;
+
+    magnitude = 20.0 * (std::log10(std::hypot(nr, ni)) - std::log10(std::hypot(dr, di)))
+        + 20.0 * std::log10(2.0) * static_cast<double>(numerator.exponent - denominator.exponent);
+    phase = std::atan2(ni * dr - nr * di, nr * dr + ni * di) * 180.0 / pi;
+}
+
+// Evaluation before the scaled Horner scheme, kept as baseline
+static void powerSumResponse(const std::vector<double>& numerator, const std::vector<double>& denominator, double frequency,
+    double& magnitude, double& phase)
+{
+    std::complex<double> s(0, frequency);
+    std::complex<double> num(0, 0);
+    std::complex<double> den(0, 0);
+
+    for (size_t i = 0; i < numerator.size(); ++i) {
+        num += numerator[i] * std::pow(s, numerator.size() - 1 - i);
+    }
+    for (size_t i = 0; i < denominator.size(); ++i) {
+        den += denominator[i] * std::pow(s, denominator.size() - 1 - i);
+    }
+
+    std::complex<double> response = num / den;
+    magnitude = 20.0 * std::log10(std::abs(response));
+    phase = std::arg(response) * 180.0 / pi;
+}
+
+// Product of the factors, highest power first
+static std::vector<double> expand(const std::vector<std::vector<double>>& factors)
+{
+    std::vector<double> result = { 1.0 };
+    for (const auto& factor : factors) {
+        result = TransferFunction::multiplyPolynomials(result, factor);
+    }
+    return result;
+}
+
+// Butterworth denominator of the given order and cutoff frequency
+static std::vector<double> butterworth(int order, double cutoff)
+{
+    std::vector<std::vector<double>> factors;
+    for (int k = 0; k < order / 2; ++k) {
+        double angle = pi * (2.0 * k + 1.0) / (2.0 * order);
+        factors.push_back({ 1.0, 2.0 * std::sin(angle) * cutoff, cutoff * cutoff });
+    }
+    if (order % 2 == 1) {
+        factors.push_back({ 1.0, cutoff });
+    }
+    return expand(factors);
+}
+
+// Reference for TransferFunction::multiplyPolynomials
+static std::vector<double> convolve(const std::vector<double>& a, const std::vector<double>& b)
+{
+    std::vector<double> result(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    return result;
+}
+
+// Largest error of a coefficient relative to the coefficient itself
+static double maxRelativeError(const std::vector<double>& values, const std::vector<double>& reference)
+{
+    if (values.size() != reference.size()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double error = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        double difference = std::abs(values[i] - reference[i]);
+        if (difference > 0.0) {
+            error = std::max(error, reference[i] != 0.0 ? difference / std::abs(reference[i]) : std::numeric_limits<double>::infinity());
+        }
+    }
+    return error;
+}
+
+struct BenchmarkCase {
+    std::string name;
+    std::vector<double> numerator;
+    std::vector<double> denominator;
+};
+
+struct Accuracy {
+    double maxMagnitudeError = 0.0;   // dB
+    double maxPhaseError = 0.0;       // degree
+    size_t invalidPoints = 0;
+};
+
+static void compare(Accuracy& accuracy, double magnitude, double phase, double referenceMagnitude, double referencePhase)
+{
+    if (!std::isfinite(magnitude) || !std::isfinite(phase)) {
+        ++accuracy.invalidPoints;
+        return;
+    }
+
+    double phaseError = std::abs(std::remainder(phase - referencePhase, 360.0));
+    accuracy.maxMagnitudeError = std::max(accuracy.maxMagnitudeError, std::abs(magnitude - referenceMagnitude));
+    accuracy.maxPhaseError = std::max(accuracy.maxPhaseError, phaseError);
+}
+
+// Nanoseconds per point, repeated until about 0.2 s have passed
+template <typename Evaluation>
+static double measure(size_t points, Evaluation evaluation)
+{
+    using Clock = std::chrono::steady_clock;
+    size_t repetitions = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+
+    do {
+        evaluation();
+        ++repetitions;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < 0.2);
+
+    return elapsed * 1e9 / (static_cast<double>(repetitions) * points);
+}
+
+int main(int argc, char* argv[])
+{
+    int pointsPerDecade = 200;
+    for (int i = 1; i < argc; i += 2) {
+        std::string option = argv[i];
+        if (option != "--points-per-decade") {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", option.c_str());
+            return 1;
+        }
+        pointsPerDecade = std::max(1, std::atoi(argv[i + 1]));
+    }
+
+    std::vector<std::vector<double>> spreadPoles;
+    for (int k = -12; k < 12; ++k) {
+        spreadPoles.push_back({ 1.0, std::pow(10.0, k / 4.0) });
+    }
+
+    std::vector<std::vector<double>> integratorChain = { { 1.0, 0.0, 0.0, 0.0 } };
+    for (int k = 0; k < 20; ++k) {
+        integratorChain.push_back({ 1.0, 100.0 });
+    }
+
+    std::vector<BenchmarkCase> cases = {
+        { "Lowpass 1/(s+1)", { 1.0 }, { 1.0, 1.0 } },
+        { "Butterworth n=20", { 1.0 }, butterworth(20, 1.0) },
+        { "Butterworth n=40, wc=1e3", { 1.0 }, butterworth(40, 1e3) },
+        { "Butterworth n=60, wc=1e3", { 1.0 }, butterworth(60, 1e3) },
+        { "(s+1)^30 expanded", { 1.0 }, expand(std::vector<std::vector<double>>(30, { 1.0, 1.0 })) },
+        { "24 poles 1e-3..1e3", expand(std::vector<std::vector<double>>(4, { 1.0, 0.5 })), expand(spreadPoles) },
+        { "(s+10)^2/(s^3 (s+100)^20)", expand({ { 1.0, 10.0 }, { 1.0, 10.0 } }), expand(integratorChain) },
+    };
+
+    std::vector<double> frequencies = FrequencyGrid(1e-6, 1e6, pointsPerDecade).createFrequencies();
+    std::vector<double> magnitudes(frequencies.size());
+    std::vector<double> phases(frequencies.size());
+
+    std::printf("%zu frequencies from 1e-6 to 1e6 rad/s, errors against a double-double reference\n\n", frequencies.size());
+    std::printf("%-28s %-14s %14s %14s %10s %10s\n", "System", "Method", "Max dB error", "Max deg error", "Invalid", "ns/point");
+
+    for (const auto& benchmarkCase : cases) {
+        TransferFunction transferFunction(benchmarkCase.numerator, benchmarkCase.denominator);
+
+        std::vector<double> referenceMagnitudes(frequencies.size());
+        std::vector<double> referencePhases(frequencies.size());
+        for (size_t k = 0; k < frequencies.size(); ++k) {
+            referenceResponse(evaluateReference(benchmarkCase.numerator, frequencies[k]), evaluateReference(benchmarkCase.denominator, frequencies[k]),
+                referenceMagnitudes[k], referencePhases[k]);
+        }
+
+        // Baseline
+        Accuracy powerSum;
+        for (size_t k = 0; k < frequencies.size(); ++k) {
+            powerSumResponse(benchmarkCase.numerator, benchmarkCase.denominator, frequencies[k], magnitudes[k], phases[k]);
+            compare(powerSum, magnitudes[k], phases[k], referenceMagnitudes[k], referencePhases[k]);
+        }
+        double powerSumTime = measure(frequencies.size(), [&]() {
+            for (size_t k = 0; k < frequencies.size(); ++k) {
+                powerSumResponse(benchmarkCase.numerator, benchmarkCase.denominator, frequencies[k], magnitudes[k], phases[k]);
+            }
+            });
+
+        // Scaled Horner scheme of TransferFunction
+        Accuracy scaled;
+        transferFunction.calculateLogFrequencyResponse(frequencies.data(), frequencies.size(), magnitudes.data(), phases.data());
+        for (size_t k = 0; k < frequencies.size(); ++k) {
+            compare(scaled, magnitudes[k], phases[k], referenceMagnitudes[k], referencePhases[k]);
+        }
+        double scaledTime = measure(frequencies.size(), [&]() {
+            transferFunction.calculateLogFrequencyResponse(frequencies.data(), frequencies.size(), magnitudes.data(), phases.data());
+            });
+
+        std::printf("%-28s %-14s %14.3g %14.3g %10zu %10.1f\n", benchmarkCase.name.c_str(), "std::pow sum",
+            powerSum.maxMagnitudeError, powerSum.maxPhaseError, powerSum.invalidPoints, powerSumTime);
+        std::printf("%-28s %-14s %14.3g %14.3g %10zu %10.1f\n", "", "scaled Horner",
+            scaled.maxMagnitudeError, scaled.maxPhaseError, scaled.invalidPoints, scaledTime);
+    }
+
+    // Polynomial products, the FFT path must agree with direct convolution coefficient by coefficient
+    std::vector<double> balancedA(600);
+    std::vector<double> balancedB(800);
+    for (size_t i = 0; i < balancedA.size(); ++i) {
+        balancedA[i] = (1.0 + 0.5 * std::sin(0.7 * i)) * std::pow(1.05, static_cast<double>(i));
+    }
+    for (size_t i = 0; i < balancedB.size(); ++i) {
+        balancedB[i] = (1.0 + 0.5 * std::cos(1.3 * i)) * std::pow(1.05, static_cast<double>(i));
+    }
+    std::vector<double> onePower = expand(std::vector<std::vector<double>>(64, { 1.0, 1.0 }));
+    std::vector<double> tenPower = expand(std::vector<std::vector<double>>(64, { 1.0, 10.0 }));
+    std::vector<double> butterworth64 = butterworth(64, 1.0);
+
+    struct ProductCase {
+        std::string name;
+        std::vector<double> a;
+        std::vector<double> b;
+    };
+    std::vector<ProductCase> products = {
+        { "((s+1)^64)^2", onePower, onePower },
+        { "((s+10)^64)^2", tenPower, tenPower },
+        { "Butterworth n=64 squared", butterworth64, butterworth64 },
+        { "balanced 600 x 800", balancedA, balancedB },
+    };
+
+    std::printf("\n%-28s %14s %14s %14s\n", "Product", "Max rel error", "ns direct", "ns multiply");
+    bool passed = true;
+    for (const auto& product : products) {
+        std::vector<double> reference = convolve(product.a, product.b);
+        double error = maxRelativeError(TransferFunction::multiplyPolynomials(product.a, product.b), reference);
+        double directTime = measure(1, [&]() { convolve(product.a, product.b); });
+        double multiplyTime = measure(1, [&]() { TransferFunction::multiplyPolynomials(product.a, product.b); });
+
+        std::printf("%-28s %14.3g %14.0f %14.0f\n", product.name.c_str(), error, directTime, multiplyTime);
+        passed = passed && error <= 1e-10;
+    }
+
+    if (!passed) {
+        std::fprintf(stderr, "multiplyPolynomials deviates from direct convolution\n");
+        return 1;
+    }
+    return 0;
+}
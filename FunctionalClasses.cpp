@@ -1,31 +1,539 @@
 ﻿#include "FunctionalClasses.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <thread>
+
+static const double pi = 3.14159265358979323846;
+
+// Brings the larger component to [0.5, 1) if it is outside 2^-400 ... 2^400, the exponent keeps
+// the magnitude. Squares and products of two values then stay within the double range.
+static ScaledComplex normalize(ScaledComplex number)
+{
+    static const double upperLimit = std::ldexp(1.0, 400);
+    static const double lowerLimit = std::ldexp(1.0, -400);
+
+    double largest = std::max(std::abs(number.value.real()), std::abs(number.value.imag()));
+    if ((largest <= upperLimit && largest >= lowerLimit) || largest == 0.0 || !std::isfinite(largest)) {
+        return number;
+    }
+
+    int shift = 0;
+    std::frexp(largest, &shift);
+    number.value = std::complex<double>(std::ldexp(number.value.real(), -shift), std::ldexp(number.value.imag(), -shift));
+    number.exponent += shift;
+    return number;
+}
+
+static ScaledComplex multiplyScaled(const ScaledComplex& a, const ScaledComplex& b)
+{
+    return normalize({ a.value * b.value, a.exponent + b.exponent });
+}
+
+// The smaller value is aligned to the exponent of the larger one
+static ScaledComplex addScaled(const ScaledComplex& a, const ScaledComplex& b)
+{
+    if (b.value == 0.0) {
+        return a;
+    }
+    if (a.value == 0.0) {
+        return b;
+    }
+    if (a.exponent >= b.exponent) {
+        return normalize({ a.value + b.value * std::exp2(b.exponent - a.exponent), a.exponent });
+    }
+    return normalize({ a.value * std::exp2(a.exponent - b.exponent) + b.value, b.exponent });
+}
+
+// Ratio of two normalized values, infinite or zero only if the ratio itself is out of range
+static std::complex<double> divideScaled(const ScaledComplex& numerator, const ScaledComplex& denominator)
+{
+    return numerator.value / denominator.value * std::exp2(numerator.exponent - denominator.exponent);
+}
+
+// Magnitude (dB) and phase (degree) of the ratio of two normalized values
+static void logRatio(const ScaledComplex& numerator, const ScaledComplex& denominator, double& magnitude, double& phase)
+{
+    const double log10Of2 = 0.30102999566398119521;
+    const double nr = numerator.value.real();
+    const double ni = numerator.value.imag();
+    const double dr = denominator.value.real();
+    const double di = denominator.value.imag();
+
+    // Both values are normalized, the squared norms can not overflow
+    magnitude = 10.0 * std::log10((nr * nr + ni * ni) / (dr * dr + di * di))
+        + 20.0 * log10Of2 * (numerator.exponent - denominator.exponent);
+    phase = std::atan2(ni * dr - nr * di, nr * dr + ni * di) * 180.0 / pi;
+}
 
 // TransferFunction class implementation
 TransferFunction::TransferFunction(const std::vector<double>& num, const std::vector<double>& den)
     : numerator(num), denominator(den) {}
 
 std::vector<std::complex<double>> TransferFunction::calculateFrequencyResponse(const std::vector<double>& frequencies) const {
-    std::vector<std::complex<double>> response;
+    std::vector<std::complex<double>> response(frequencies.size());
+    Profiler::instance().addCounter("Buffer allocations", 1);
 
-    for (double omega : frequencies) {
-        std::complex<double> s(0, omega);  // s = jω
-        std::complex<double> num(0, 0);
-        std::complex<double> den(0, 0);
+    calculateFrequencyResponse(frequencies.data(), frequencies.size(), response.data());
 
-        for (size_t i = 0; i < numerator.size(); ++i) {
-            num += numerator[i] * std::pow(s, numerator.size() - 1 - i);
+    return response;
+}
+
+void TransferFunction::calculateFrequencyResponse(const double* frequencies, size_t count, std::complex<double>* response) const {
+    Profiler::instance().addCounter("Evaluated points", static_cast<long long>(count));
+
+    if (structure != Structure::Polynomial) {
+        std::vector<ScaledComplex> numeratorValues(count);
+        std::vector<ScaledComplex> denominatorValues(count);
+        Profiler::instance().addCounter("Buffer allocations", 2);
+
+        evaluate(frequencies, count, numeratorValues.data(), denominatorValues.data());
+        for (size_t k = 0; k < count; ++k) {
+            response[k] = divideScaled(numeratorValues[k], denominatorValues[k]);
         }
+        return;
+    }
 
-        for (size_t i = 0; i < denominator.size(); ++i) {
-            den += denominator[i] * std::pow(s, denominator.size() - 1 - i);
+    for (size_t k = 0; k < count; ++k) {
+        response[k] = divideScaled(evaluatePolynomial(numerator, frequencies[k]), evaluatePolynomial(denominator, frequencies[k]));
+    }
+}
+
+void TransferFunction::calculateLogFrequencyResponse(const double* frequencies, size_t count, double* magnitudes, double* phases) const {
+    Profiler::instance().addCounter("Evaluated points", static_cast<long long>(count));
+
+    if (structure != Structure::Polynomial) {
+        std::vector<ScaledComplex> numeratorValues(count);
+        std::vector<ScaledComplex> denominatorValues(count);
+        Profiler::instance().addCounter("Buffer allocations", 2);
+
+        evaluate(frequencies, count, numeratorValues.data(), denominatorValues.data());
+        for (size_t k = 0; k < count; ++k) {
+            logRatio(numeratorValues[k], denominatorValues[k], magnitudes[k], phases[k]);
         }
+        return;
+    }
 
-        response.push_back(num / den);
+    for (size_t k = 0; k < count; ++k) {
+        logRatio(evaluatePolynomial(numerator, frequencies[k]), evaluatePolynomial(denominator, frequencies[k]), magnitudes[k], phases[k]);
     }
+}
 
-    return response;
+// Horner scheme with error-free transformations (Graillat, Langlois, Louvet). The rounding errors
+// of every step are collected in a second Horner scheme, the result is about as accurate as with
+// twice the double precision. tau = -1 / frequency is split into two doubles for the same reason.
+static void evaluateCompensated(const std::vector<double>& coefficients, size_t first, size_t last, bool reversed, double frequency,
+    double& real, double& imag, int& shift)
+{
+    const size_t degree = last - first - 1;
+    const double tauHigh = reversed ? -1.0 / frequency : frequency;
+    const double tauLow = reversed ? -std::fma(tauHigh, frequency, 1.0) / frequency : 0.0;
+    static const double overflowLimit = std::ldexp(1.0, 400);
+
+    real = reversed ? coefficients[last - 1] : coefficients[first];
+    imag = 0.0;
+    shift = 0;
+    double correctionReal = 0.0;
+    double correctionImag = 0.0;
+
+    for (size_t i = 1; i <= degree; ++i) {
+        double coefficient = reversed ? coefficients[last - 1 - i] : coefficients[first + i];
+        if (shift != 0) {
+            coefficient = std::ldexp(coefficient, -shift);
+        }
+
+        // coefficient - imag * tau with the exact errors of product and sum
+        double product = imag * tauHigh;
+        double productError = std::fma(imag, tauHigh, -product) + imag * tauLow;
+        double sum = coefficient - product;
+        double virtualProduct = coefficient - sum;
+        double sumError = (coefficient - (sum + virtualProduct)) + (virtualProduct - product);
+
+        // real * tau with its exact error
+        double nextImag = real * tauHigh;
+        double nextImagError = std::fma(real, tauHigh, -nextImag) + real * tauLow;
+
+        double nextCorrectionReal = sumError - productError - correctionImag * tauHigh;
+        correctionImag = correctionReal * tauHigh + nextImagError;
+        correctionReal = nextCorrectionReal;
+        real = sum;
+        imag = nextImag;
+
+        if (std::abs(real) > overflowLimit || std::abs(imag) > overflowLimit) {
+            real = std::ldexp(real, -400);
+            imag = std::ldexp(imag, -400);
+            correctionReal = std::ldexp(correctionReal, -400);
+            correctionImag = std::ldexp(correctionImag, -400);
+            shift += 400;
+        }
+    }
+
+    real += correctionReal;
+    imag += correctionImag;
+}
+
+ScaledComplex TransferFunction::evaluatePolynomial(const std::vector<double>& coefficients, double frequency) {
+    // Leading zeros do not change the polynomial, trailing zeros are factors s
+    size_t first = 0;
+    while (first < coefficients.size() && coefficients[first] == 0.0) {
+        ++first;
+    }
+    size_t last = coefficients.size();
+    while (last > first && coefficients[last - 1] == 0.0) {
+        --last;
+    }
+    if (first == last) {
+        return ScaledComplex();
+    }
+
+    const size_t rootsInOrigin = coefficients.size() - last;
+    const size_t degree = last - first - 1;
+    if (frequency == 0.0) {
+        return rootsInOrigin > 0 ? ScaledComplex() : normalize({ coefficients[last - 1], 0.0 });
+    }
+
+    // Horner in t = s for |s| <= 1, otherwise p(s) = s^n * q(1/s) with the reversed polynomial q.
+    // Both times t is imaginary, t = j*tau, and every term stays below the largest coefficient.
+    const bool reversed = std::abs(frequency) > 1.0;
+    const double tau = reversed ? -1.0 / frequency : frequency;
+    const double absTau = std::abs(tau);
+    static const double overflowLimit = std::ldexp(1.0, 400);
+
+    double real = reversed ? coefficients[last - 1] : coefficients[first];
+    double imag = 0.0;
+    double bound = std::abs(real);   // sum of |a_i t^i|, limits the rounding error
+    int shift = 0;                   // the sum is real + j imag times 2^shift
+    for (size_t i = 1; i <= degree; ++i) {
+        double coefficient = reversed ? coefficients[last - 1 - i] : coefficients[first + i];
+        if (shift != 0) {
+            coefficient = std::ldexp(coefficient, -shift);
+        }
+
+        // (real + j imag) * j tau + coefficient
+        double nextReal = coefficient - imag * tau;
+        imag = real * tau;
+        real = nextReal;
+        bound = bound * absTau + std::abs(coefficient);
+
+        // Only huge coefficients get here
+        if (bound > overflowLimit) {
+            real = std::ldexp(real, -400);
+            imag = std::ldexp(imag, -400);
+            bound = std::ldexp(bound, -400);
+            shift += 400;
+        }
+    }
+
+    // Rounding error below 2 n eps * bound. Near clustered roots the value is much smaller than
+    // the bound, these points are evaluated again with the compensated scheme.
+    const double errorBound = 2.0 * degree * std::numeric_limits<double>::epsilon() * bound;
+    if (errorBound * errorBound > 1e-20 * (real * real + imag * imag)) {
+        evaluateCompensated(coefficients, first, last, reversed, frequency, real, imag, shift);
+    }
+
+    // Factor s^powers = j^powers * frequency^powers, the magnitude goes into the exponent
+    const size_t powers = rootsInOrigin + (reversed ? degree : 0);
+    if (frequency < 0.0 && powers % 2 == 1) {
+        real = -real;
+        imag = -imag;
+    }
+
+    ScaledComplex result;
+    switch (powers % 4) {
+    case 0: result.value = std::complex<double>(real, imag); break;
+    case 1: result.value = std::complex<double>(-imag, real); break;
+    case 2: result.value = std::complex<double>(-real, -imag); break;
+    default: result.value = std::complex<double>(imag, -real); break;
+    }
+    result.exponent = shift;
+    if (powers > 0) {
+        result.exponent += powers * std::log2(std::abs(frequency));
+    }
+    return normalize(result);
+}
+
+void TransferFunction::evaluate(const double* frequencies, size_t count, ScaledComplex* numeratorValues, ScaledComplex* denominatorValues) const {
+    if (structure == Structure::Polynomial) {
+        for (size_t k = 0; k < count; ++k) {
+            numeratorValues[k] = evaluatePolynomial(numerator, frequencies[k]);
+            denominatorValues[k] = evaluatePolynomial(denominator, frequencies[k]);
+        }
+        return;
+    }
+
+    std::vector<ScaledComplex> secondNumerator(count);
+    std::vector<ScaledComplex> secondDenominator(count);
+    Profiler::instance().addCounter("Buffer allocations", 2);
+
+    first->evaluate(frequencies, count, numeratorValues, denominatorValues);
+    second->evaluate(frequencies, count, secondNumerator.data(), secondDenominator.data());
+
+    // Same formulas as for the expanded coefficients, only with values instead of polynomials
+    for (size_t k = 0; k < count; ++k) {
+        ScaledComplex n1 = numeratorValues[k];
+        ScaledComplex d1 = denominatorValues[k];
+        ScaledComplex n2 = secondNumerator[k];
+        ScaledComplex d2 = secondDenominator[k];
+
+        switch (structure) {
+        case Structure::Series:
+            numeratorValues[k] = multiplyScaled(n1, n2);
+            denominatorValues[k] = multiplyScaled(d1, d2);
+            break;
+        case Structure::Parallel:
+            numeratorValues[k] = addScaled(multiplyScaled(n1, d2), multiplyScaled(n2, d1));
+            denominatorValues[k] = multiplyScaled(d1, d2);
+            break;
+        case Structure::NegativeFeedback:
+        case Structure::PositiveFeedback:
+        {
+            ScaledComplex loop = multiplyScaled(n1, n2);
+            if (structure == Structure::PositiveFeedback) {
+                loop.value = -loop.value;
+            }
+            numeratorValues[k] = multiplyScaled(n1, d2);
+            denominatorValues[k] = addScaled(multiplyScaled(d1, d2), loop);
+            break;
+        }
+        case Structure::Polynomial:
+            break;
+        }
+    }
+}
+
+TransferFunction TransferFunction::compose(Structure structure, const TransferFunction& first, const TransferFunction& second,
+    Composition composition, const std::vector<double>& num, const std::vector<double>& den) {
+    TransferFunction result(num, den);
+    if (composition == Composition::Factored) {
+        result.structure = structure;
+        result.first = std::make_shared<const TransferFunction>(first);
+        result.second = std::make_shared<const TransferFunction>(second);
+    }
+    return result;
+}
+
+TransferFunction TransferFunction::series(const TransferFunction& first, const TransferFunction& second, Composition composition) {
+    return compose(Structure::Series, first, second, composition,
+        multiplyPolynomials(first.numerator, second.numerator),
+        multiplyPolynomials(first.denominator, second.denominator));
+}
+
+TransferFunction TransferFunction::parallel(const TransferFunction& first, const TransferFunction& second, Composition composition) {
+    return compose(Structure::Parallel, first, second, composition,
+        addPolynomials(multiplyPolynomials(first.numerator, second.denominator), multiplyPolynomials(second.numerator, first.denominator)),
+        multiplyPolynomials(first.denominator, second.denominator));
+}
+
+TransferFunction TransferFunction::feedback(const TransferFunction& forward, const TransferFunction& backward, bool positive, Composition composition) {
+    std::vector<double> loopNumerator = multiplyPolynomials(forward.numerator, backward.numerator);
+    if (positive) {
+        for (double& value : loopNumerator) {
+            value = -value;
+        }
+    }
+
+    return compose(positive ? Structure::PositiveFeedback : Structure::NegativeFeedback, forward, backward, composition,
+        multiplyPolynomials(forward.numerator, backward.denominator),
+        addPolynomials(multiplyPolynomials(forward.denominator, backward.denominator), loopNumerator));
+}
+
+// In-place radix-2 FFT, the size must be a power of two. The inverse is not divided by the size.
+static void fourierTransform(std::vector<std::complex<double>>& values, bool inverse)
+{
+    const size_t n = values.size();
+
+    // Bit reversed order
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(values[i], values[j]);
+        }
+    }
+
+    // Twiddle factors are computed directly, a recurrence would accumulate rounding errors
+    std::vector<std::complex<double>> twiddles(n / 2);
+    for (size_t k = 0; k < n / 2; ++k) {
+        twiddles[k] = std::polar(1.0, (inverse ? 2.0 : -2.0) * 3.14159265358979323846 * k / n);
+    }
+
+    for (size_t length = 2; length <= n; length <<= 1) {
+        const size_t half = length / 2;
+        const size_t stride = n / length;
+        for (size_t start = 0; start < n; start += length) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<double> even = values[start + k];
+                std::complex<double> odd = values[start + k + half] * twiddles[k * stride];
+                values[start + k] = even + odd;
+                values[start + k + half] = even - odd;
+            }
+        }
+    }
+}
+
+// Plain convolution, each coefficient of the product has a small relative error
+static std::vector<double> convolve(const std::vector<double>& a, const std::vector<double>& b)
+{
+    std::vector<double> result(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            result[i + j] += a[i] * b[j];
+        }
+    }
+    return result;
+}
+
+// x * 2^exponent for a real exponent, the fraction is applied with exp2 and the integer part exactly
+static double scaleByPower(double x, double exponent)
+{
+    double integerPart = std::floor(exponent);
+    return std::ldexp(x * std::exp2(exponent - integerPart), static_cast<int>(integerPart));
+}
+
+// Scales the coefficient of s^k by 2^(k * shift - offset), offset brings the largest one to about 1.
+// Returns false if a coefficient is zero or the scaled coefficients differ by more than 2^maxSpread.
+static bool balanceCoefficients(const std::vector<double>& coefficients, double shift, double maxSpread, std::vector<double>& scaled, double& offset)
+{
+    const size_t degree = coefficients.size() - 1;
+    double largest = -std::numeric_limits<double>::infinity();
+    double smallest = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i <= degree; ++i) {
+        if (coefficients[i] == 0.0 || !std::isfinite(coefficients[i])) {
+            return false;
+        }
+        double exponent = std::log2(std::abs(coefficients[i])) + shift * (degree - i);
+        largest = std::max(largest, exponent);
+        smallest = std::min(smallest, exponent);
+    }
+    if (largest - smallest > maxSpread) {
+        return false;
+    }
+
+    offset = std::round(largest);
+    scaled.resize(coefficients.size());
+    for (size_t i = 0; i <= degree; ++i) {
+        scaled[i] = scaleByPower(coefficients[i], shift * (degree - i) - offset);
+    }
+    return true;
+}
+
+// FFT based product of a and b. Only used when the substitution s -> 2^shift * s brings all
+// coefficients to a similar magnitude, otherwise the rounding error relative to the largest
+// coefficient would wipe out the small ones. Returns false if the result can not be trusted.
+static bool multiplyWithFourierTransform(const std::vector<double>& a, const std::vector<double>& b, std::vector<double>& result)
+{
+    // Coefficients differ by at most 2^8 after scaling, the error check below decides
+    const double maxSpread = 8.0;
+
+    // Shift that equalizes the first and last coefficient of the product
+    if (a.front() == 0.0 || a.back() == 0.0 || b.front() == 0.0 || b.back() == 0.0) {
+        return false;
+    }
+    const size_t degree = a.size() + b.size() - 2;
+    const double shift = std::log2(std::abs(a.back() * b.back() / (a.front() * b.front()))) / degree;
+    if (!std::isfinite(shift)) {
+        return false;
+    }
+
+    std::vector<double> scaledA;
+    std::vector<double> scaledB;
+    double offsetA = 0.0;
+    double offsetB = 0.0;
+    if (!balanceCoefficients(a, shift, maxSpread, scaledA, offsetA) || !balanceCoefficients(b, shift, maxSpread, scaledB, offsetB)) {
+        return false;
+    }
+
+    const size_t resultSize = degree + 1;
+    size_t n = 1;
+    while (n < resultSize) {
+        n <<= 1;
+    }
+
+    // Both polynomials are packed into one complex sequence a + ib. Its square is
+    // a^2 - b^2 + 2iab, so one forward and one inverse FFT suffice.
+    std::vector<std::complex<double>> values(n);
+    double normA = 0.0;
+    double normB = 0.0;
+    for (size_t i = 0; i < scaledA.size(); ++i) {
+        values[i].real(scaledA[i]);
+        normA += scaledA[i] * scaledA[i];
+    }
+    for (size_t i = 0; i < scaledB.size(); ++i) {
+        values[i].imag(scaledB[i]);
+        normB += scaledB[i] * scaledB[i];
+    }
+
+    fourierTransform(values, false);
+    for (auto& value : values) {
+        value *= value;
+    }
+    fourierTransform(values, true);
+
+    // The rounding error of the FFT is spread evenly over all coefficients. It is measured on the
+    // outer coefficients, which are short sums and cheap to compute directly, and every coefficient
+    // must then be accurate to about 1e-11.
+    const size_t sampleCount = std::min<size_t>(8, std::min(scaledA.size(), scaledB.size()));
+    std::vector<double> product(resultSize);
+    for (size_t i = 0; i < resultSize; ++i) {
+        product[i] = values[i].imag() / (2.0 * n);
+    }
+    double errorEstimate = std::numeric_limits<double>::epsilon() * std::sqrt(normA * normB);
+    for (size_t k = 0; k < sampleCount; ++k) {
+        double first = 0.0;
+        double last = 0.0;
+        for (size_t j = 0; j <= k; ++j) {
+            first += scaledA[j] * scaledB[k - j];
+            last += scaledA[scaledA.size() - 1 - j] * scaledB[scaledB.size() - 1 - k + j];
+        }
+        errorEstimate = std::max(errorEstimate, std::abs(product[k] - first));
+        errorEstimate = std::max(errorEstimate, std::abs(product[resultSize - 1 - k] - last));
+        product[k] = first;
+        product[resultSize - 1 - k] = last;
+    }
+
+    result.resize(resultSize);
+    for (size_t i = 0; i < resultSize; ++i) {
+        double value = product[i];
+        if (!(std::abs(value) * 1e-11 >= 10.0 * errorEstimate)) {
+            return false;
+        }
+        result[i] = scaleByPower(value, offsetA + offsetB - shift * (degree - i));
+    }
+    return true;
+}
+
+std::vector<double> TransferFunction::multiplyPolynomials(const std::vector<double>& a, const std::vector<double>& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+
+    // Direct convolution is faster below about 512 coefficients and the default for all
+    // polynomials whose coefficients can not be balanced
+    std::vector<double> result;
+    if (std::min(a.size(), b.size()) >= 512 && multiplyWithFourierTransform(a, b, result)) {
+        return result;
+    }
+    return convolve(a, b);
+}
+
+std::vector<double> TransferFunction::addPolynomials(const std::vector<double>& a, const std::vector<double>& b) {
+    // Aligned at the lowest power
+    const std::vector<double>& longer = a.size() >= b.size() ? a : b;
+    const std::vector<double>& shorter = a.size() >= b.size() ? b : a;
+
+    std::vector<double> result(longer);
+    const size_t offset = longer.size() - shorter.size();
+    for (size_t i = 0; i < shorter.size(); ++i) {
+        result[offset + i] += shorter[i];
+    }
+    return result;
 }
 
 const std::vector<double>& TransferFunction::getNumerator() const {
@@ -36,41 +544,310 @@ const std::vector<double>& TransferFunction::getDenominator() const {
     return denominator;
 }
 
-// FrequencyResponse class implementation
-FrequencyResponse::FrequencyResponse(const std::vector<double>& freqs)
-    : frequencies(freqs) {}
+bool TransferFunction::isFactored() const {
+    return structure != Structure::Polynomial;
+}
 
-void FrequencyResponse::compute(const TransferFunction& transferFunction) {
-    std::vector<std::complex<double>> response = transferFunction.calculateFrequencyResponse(frequencies);
+std::vector<std::complex<double>> TransferFunction::getZeros() const {
+    return findRoots(numerator);
+}
+
+std::vector<std::complex<double>> TransferFunction::getPoles() const {
+    return findRoots(denominator);
+}
 
-    magnitudes.clear();
-    phases.clear();
+std::vector<std::complex<double>> TransferFunction::findRoots(const std::vector<double>& coefficients) {
+    std::vector<std::complex<double>> roots;
 
-    double previous_phase = 0.0; // Startwert für die vorherige Phase
+    // Leading zeros do not change the polynomial
+    size_t first = 0;
+    while (first < coefficients.size() && coefficients[first] == 0.0) {
+        ++first;
+    }
+
+    // Trailing zeros are roots in the origin
+    size_t last = coefficients.size();
+    while (last > first + 1 && coefficients[last - 1] == 0.0) {
+        roots.push_back(0.0);
+        --last;
+    }
+
+    if (last <= first + 1) {
+        return roots;
+    }
 
-    for (const auto& r : response) {
-        // Calculation of magnitude in dB
-        magnitudes.push_back(20 * std::log10(std::abs(r)));
+    // Monic polynomial a[0] = 1, a[1], ..., a[n]
+    std::vector<double> a(coefficients.begin() + first, coefficients.begin() + last);
+    const double leading = a[0];
+    for (double& value : a) {
+        value /= leading;
+    }
+    const size_t degree = a.size() - 1;
 
-        // Calculate phase and convert into degree
-        double phase = std::arg(r) * 180 / 3.141592;
+    // Start values on a circle with the geometric mean of the root magnitudes as radius
+    double radius = std::pow(std::abs(a[degree]), 1.0 / degree);
+    if (radius == 0.0 || !std::isfinite(radius)) {
+        radius = 1.0;
+    }
 
-        // Phase Unwrapping to cure anomalies
-        if (!phases.empty()) {
-            double phase_diff = phase - previous_phase;
-            if (phase_diff > 180.0) {
-                phase -= 360.0; 
+    std::vector<std::complex<double>> z(degree);
+    for (size_t i = 0; i < degree; ++i) {
+        double angle = 2.0 * 3.14159265358979323846 * i / degree + 0.4;
+        z[i] = std::polar(radius, angle);
+    }
+
+    // Aberth-Ehrlich iteration, converges for all roots simultaneously
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        double maxCorrection = 0.0;
+
+        for (size_t i = 0; i < degree; ++i) {
+            // Horner for p(z) and p'(z)
+            std::complex<double> p = a[0];
+            std::complex<double> dp = 0.0;
+            for (size_t k = 1; k <= degree; ++k) {
+                dp = dp * z[i] + p;
+                p = p * z[i] + a[k];
+            }
+            if (p == 0.0) {
+                continue;
             }
-            else if (phase_diff < -180.0) {
-                phase += 360.0;
+
+            std::complex<double> ratio = p / dp;
+            std::complex<double> sum = 0.0;
+            for (size_t j = 0; j < degree; ++j) {
+                if (j != i) {
+                    sum += 1.0 / (z[i] - z[j]);
+                }
             }
+
+            std::complex<double> correction = ratio / (1.0 - ratio * sum);
+            if (!std::isfinite(correction.real()) || !std::isfinite(correction.imag())) {
+                continue;
+            }
+            z[i] -= correction;
+            maxCorrection = std::max(maxCorrection, std::abs(correction) / std::max(std::abs(z[i]), 1e-300));
+        }
+
+        if (maxCorrection < 1e-14) {
+            break;
+        }
+    }
+
+    // Roots of a real polynomial are real or conjugate pairs, remove numerical noise
+    for (auto& root : z) {
+        if (std::abs(root.imag()) < 1e-10 * std::abs(root)) {
+            root = root.real();
+        }
+    }
+
+    roots.insert(roots.end(), z.begin(), z.end());
+    return roots;
+}
+
+// FrequencyGrid class implementation
+FrequencyGrid::FrequencyGrid(double start, double end, int pointsPerDecade)
+    : startFrequency(start), endFrequency(end), pointsPerDecade(pointsPerDecade) {}
+
+FrequencyGrid FrequencyGrid::fromTransferFunction(const TransferFunction& transferFunction) {
+    std::vector<std::complex<double>> roots = transferFunction.getZeros();
+    std::vector<std::complex<double>> poles = transferFunction.getPoles();
+    roots.insert(roots.end(), poles.begin(), poles.end());
+
+    double minCorner = std::numeric_limits<double>::max();
+    double maxCorner = 0.0;
+    double minDamping = 1.0;
+
+    for (const auto& root : roots) {
+        double corner = std::abs(root);
+
+        // Roots in the origin (integrators, differentiators) have no corner frequency
+        if (corner < 1e-12 || !std::isfinite(corner)) {
+            continue;
+        }
+
+        minCorner = std::min(minCorner, corner);
+        maxCorner = std::max(maxCorner, corner);
+
+        if (root.imag() != 0.0) {
+            minDamping = std::min(minDamping, std::abs(root.real()) / corner);
         }
+    }
+
+    // Without any corner the plot is centered around 1 rad/s
+    if (maxCorner == 0.0) {
+        minCorner = 1.0;
+        maxCorner = 1.0;
+    }
+
+    // Two decades beyond the extreme corners, rounded to full decades
+    double start = std::pow(10.0, std::floor(std::log10(minCorner)) - 2.0);
+    double end = std::pow(10.0, std::ceil(std::log10(maxCorner)) + 2.0);
+
+    // A resonance peak is about 2*damping wide (relative), it should be covered by several points
+    const int minPointsPerDecade = 200;
+    const int maxPointsPerDecade = 5000;
+    const double maxPoints = 50000.0;
+    double points = 6.0 / std::max(minDamping, 1e-4);
+    int pointsPerDecade = static_cast<int>(std::min(std::max(points, double(minPointsPerDecade)), double(maxPointsPerDecade)));
+
+    // Limit the total amount of points for very wide ranges
+    double decades = std::log10(end / start);
+    if (decades * pointsPerDecade > maxPoints) {
+        pointsPerDecade = std::max(minPointsPerDecade / 4, static_cast<int>(maxPoints / decades));
+    }
+
+    return FrequencyGrid(start, end, pointsPerDecade);
+}
+
+FrequencyGrid FrequencyGrid::withBounds(double userStart, double userEnd, std::string& note) const {
+    double start = startFrequency;
+    double end = endFrequency;
+    double span = end / start;
+
+    note.clear();
+    if (userStart > 0.0 && userEnd > 0.0) {
+        if (userEnd > userStart) {
+            start = userStart;
+            end = userEnd;
+        }
+        else {
+            note = "end not above start, automatic range used";
+        }
+    }
+    else if (userStart > 0.0) {
+        start = userStart;
+        if (end <= start) {
+            end = start * span;
+            note = "automatic end moved above start";
+        }
+    }
+    else if (userEnd > 0.0) {
+        end = userEnd;
+        if (start >= end) {
+            start = end / span;
+            note = "automatic start moved below end";
+        }
+    }
+
+    return FrequencyGrid(start, end, pointsPerDecade);
+}
+
+std::vector<double> FrequencyGrid::createFrequencies() const {
+    std::vector<double> frequencies;
+
+    double decades = std::log10(endFrequency) - std::log10(startFrequency);
+    int numPoints = std::max(2, static_cast<int>(std::ceil(decades * pointsPerDecade)) + 1);
+    frequencies.reserve(numPoints);
+    Profiler::instance().addCounter("Buffer allocations", 1);
+
+    // Generate 'numPoints' frequency values equally spaced on a log scale between start and end.
+    for (int i = 0; i < numPoints; ++i) {
+        double exponent = std::log10(startFrequency) + i * decades / (numPoints - 1);
+        frequencies.push_back(std::pow(10.0, exponent));
+    }
+
+    return frequencies;
+}
+
+double FrequencyGrid::getStartFrequency() const {
+    return startFrequency;
+}
+
+double FrequencyGrid::getEndFrequency() const {
+    return endFrequency;
+}
+
+int FrequencyGrid::getPointsPerDecade() const {
+    return pointsPerDecade;
+}
+
+// FrequencyResponse class implementation
+FrequencyResponse::FrequencyResponse(std::shared_ptr<const std::vector<double>> freqs)
+    : frequencies(std::move(freqs)) {}
+
+FrequencyResponse::FrequencyResponse(const double* freqs, const double* mags, const double* phs, size_t count)
+    : frequencies(std::make_shared<const std::vector<double>>(freqs, freqs + count)), magnitudes(mags, mags + count), phases(phs, phs + count) {}
+
+void FrequencyResponse::compute(const TransferFunction& transferFunction) {
+    prepareResults();
+    transferFunction.calculateLogFrequencyResponse(frequencies->data(), frequencies->size(), magnitudes.data(), phases.data());
+    unwrapPhases();
+}
+
+void parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+std::vector<FrequencyResponse> FrequencyResponse::computeBatch(const std::shared_ptr<const std::vector<double>>& freqs, const std::vector<const TransferFunction*>& transferFunctions) {
+    const size_t systemCount = transferFunctions.size();
+    const size_t chunkSize = 1024;
+    const size_t chunkCount = (freqs->size() + chunkSize - 1) / chunkSize;
+
+    std::vector<FrequencyResponse> results(systemCount, FrequencyResponse(freqs));
+    for (auto& result : results) {
+        result.prepareResults();
+    }
+
+    // One task per system and frequency chunk, so few systems with many points also use all cores
+    parallelFor(systemCount * chunkCount, [&](size_t task) {
+        size_t system = task / chunkCount;
+        size_t first = (task % chunkCount) * chunkSize;
+        size_t count = std::min(chunkSize, freqs->size() - first);
+        transferFunctions[system]->calculateLogFrequencyResponse(freqs->data() + first, count,
+            results[system].magnitudes.data() + first, results[system].phases.data() + first);
+        });
+
+    parallelFor(systemCount, [&](size_t system) {
+        results[system].unwrapPhases();
+        });
+
+    return results;
+}
 
-        phases.push_back(phase);
-        previous_phase = phase;
+void FrequencyResponse::prepareResults() {
+    // Reuse the buffers of a previous computation if they are large enough
+    if (magnitudes.capacity() < frequencies->size()) {
+        Profiler::instance().addCounter("Buffer allocations", 2);
     }
+    magnitudes.resize(frequencies->size());
+    phases.resize(frequencies->size());
 }
 
+void FrequencyResponse::unwrapPhases() {
+    // Neighbouring points differ by less than 180 degree. High orders wrap several times,
+    // so whole turns are removed relative to the last valid phase.
+    double previousPhase = 0.0;
+    bool hasPrevious = false;
+
+    for (double& phase : phases) {
+        if (!std::isfinite(phase)) {
+            continue;
+        }
+        if (hasPrevious) {
+            phase -= 360.0 * std::round((phase - previousPhase) / 360.0);
+        }
+        previousPhase = phase;
+        hasPrevious = true;
+    }
+}
 
 const std::vector<double>& FrequencyResponse::getMagnitudes() const {
     return magnitudes;
@@ -81,7 +858,7 @@ const std::vector<double>& FrequencyResponse::getPhases() const {
 }
 
 const std::vector<double>& FrequencyResponse::getFrequencies() const {
-    return frequencies;
+    return *frequencies;
 }
 
 
@@ -89,6 +866,11 @@ StabilityAnalyzer::StabilityAnalyzer()
     : amplitudeMargin("-"), phaseMargin("-"),
     phaseCrossoverFrequency("-"), gainCrossoverFrequency("-") {}
 
+StabilityAnalyzer::StabilityAnalyzer(const std::string& amplitudeMargin, const std::string& phaseMargin,
+    const std::string& phaseCrossoverFrequency, const std::string& gainCrossoverFrequency)
+    : amplitudeMargin(amplitudeMargin), phaseMargin(phaseMargin),
+    phaseCrossoverFrequency(phaseCrossoverFrequency), gainCrossoverFrequency(gainCrossoverFrequency) {}
+
 
 void StabilityAnalyzer::analyze(const TransferFunction& transferFunction, const FrequencyResponse& frequencyResponse)
 {
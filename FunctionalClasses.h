@@ -3,31 +3,128 @@
 
 #include <vector>
 #include <complex>
+#include <functional>
+#include <memory>
 #include <string>
 
+// Runs task(0) ... task(count - 1) on all available cores
+void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+// Complex value * 2^exponent. Numerator and denominator values of high order polynomials at
+// extreme frequencies exceed the double range long before their ratio does.
+struct ScaledComplex {
+    std::complex<double> value;
+    double exponent = 0.0;
+};
+
 // TransferFunction class
+// Compositions (series, parallel, feedback) always provide the multiplied out polynomials. A factored
+// composition also keeps its parts and evaluates them separately per frequency, which avoids the
+// rounding errors of the expanded high order coefficients.
 class TransferFunction {
+public:
+    enum class Composition { Expanded, Factored };
+
 private:
+    enum class Structure { Polynomial, Series, Parallel, NegativeFeedback, PositiveFeedback };
+
     std::vector<double> numerator;
     std::vector<double> denominator;
+    Structure structure = Structure::Polynomial;
+    std::shared_ptr<const TransferFunction> first;
+    std::shared_ptr<const TransferFunction> second;
+
+    static TransferFunction compose(Structure structure, const TransferFunction& first, const TransferFunction& second,
+        Composition composition, const std::vector<double>& num, const std::vector<double>& den);
+
+    // Numerator and denominator values at s = j*w, factored compositions combine the values of their parts
+    void evaluate(const double* frequencies, size_t count, ScaledComplex* numeratorValues, ScaledComplex* denominatorValues) const;
 
 public:
     TransferFunction(const std::vector<double>& num, const std::vector<double>& den);
     std::vector<std::complex<double>> calculateFrequencyResponse(const std::vector<double>& frequencies) const;
+    // Evaluates 'count' frequencies into 'response', used to split a sweep into chunks
+    void calculateFrequencyResponse(const double* frequencies, size_t count, std::complex<double>* response) const;
+    // Magnitude (dB) and phase (degree, within -180 ... 180) without forming the complex ratio,
+    // finite wherever the response itself is finite and non-zero
+    void calculateLogFrequencyResponse(const double* frequencies, size_t count, double* magnitudes, double* phases) const;
     const std::vector<double>& getNumerator() const;
     const std::vector<double>& getDenominator() const;
+    bool isFactored() const;
+
+    // Roots of numerator (zeros) and denominator (poles)
+    std::vector<std::complex<double>> getZeros() const;
+    std::vector<std::complex<double>> getPoles() const;
+
+    // Roots of a polynomial given with the highest power first
+    static std::vector<std::complex<double>> findRoots(const std::vector<double>& coefficients);
+
+    // Value of a polynomial (highest power first) at s = j*frequency. Horner runs in 1/s above
+    // |frequency| = 1, the power s^n and roots in the origin go into the exponent and an exact
+    // quarter turn, so no intermediate value overflows.
+    static ScaledComplex evaluatePolynomial(const std::vector<double>& coefficients, double frequency);
+
+    // first * second
+    static TransferFunction series(const TransferFunction& first, const TransferFunction& second, Composition composition = Composition::Expanded);
+    // first + second
+    static TransferFunction parallel(const TransferFunction& first, const TransferFunction& second, Composition composition = Composition::Expanded);
+    // forward / (1 + forward * backward), with positive feedback forward / (1 - forward * backward)
+    static TransferFunction feedback(const TransferFunction& forward, const TransferFunction& backward, bool positive = false,
+        Composition composition = Composition::Expanded);
+
+    // Polynomials with the highest power first. Long polynomials whose coefficients can be brought
+    // to a similar magnitude by scaling s are multiplied with an FFT, all others by direct convolution.
+    static std::vector<double> multiplyPolynomials(const std::vector<double>& a, const std::vector<double>& b);
+    static std::vector<double> addPolynomials(const std::vector<double>& a, const std::vector<double>& b);
+};
+
+// FrequencyGrid class
+// Logarithmic frequency grid (rad/s). Can be derived from the pole/zero locations of a transfer function.
+class FrequencyGrid {
+private:
+    double startFrequency;
+    double endFrequency;
+    int pointsPerDecade;
+
+public:
+    FrequencyGrid(double start, double end, int pointsPerDecade);
+
+    // Covers two decades beyond the lowest and highest corner frequency. Lightly damped
+    // poles/zeros get more points per decade so resonance peaks are resolved.
+    static FrequencyGrid fromTransferFunction(const TransferFunction& transferFunction);
+
+    // Replaces the bounds by user values, 0 keeps a bound. A kept bound that conflicts with the
+    // user bound is moved to keep the span, 'note' tells when a bound was moved or ignored.
+    FrequencyGrid withBounds(double userStart, double userEnd, std::string& note) const;
+
+    std::vector<double> createFrequencies() const;
+    double getStartFrequency() const;
+    double getEndFrequency() const;
+    int getPointsPerDecade() const;
 };
 
 // FrequencyResponse class
 class FrequencyResponse {
 private:
-    std::vector<double> frequencies;
+    // Shared with the grid cache and the other results of a batch
+    std::shared_ptr<const std::vector<double>> frequencies;
     std::vector<double> magnitudes;
     std::vector<double> phases;
 
+    // Sizes magnitudes and phases to the frequencies
+    void prepareResults();
+    // Removes the jumps of whole turns from the phases
+    void unwrapPhases();
+
 public:
-    FrequencyResponse(const std::vector<double>& freqs);
+    FrequencyResponse(std::shared_ptr<const std::vector<double>> freqs);
+    // Restores an already computed response, e.g. from a session file
+    FrequencyResponse(const double* freqs, const double* mags, const double* phs, size_t count);
     void compute(const TransferFunction& transferFunction);
+
+    // Evaluates several transfer functions on one shared frequency grid in a single parallel pass
+    static std::vector<FrequencyResponse> computeBatch(const std::shared_ptr<const std::vector<double>>& freqs, const std::vector<const TransferFunction*>& transferFunctions);
+
     const std::vector<double>& getMagnitudes() const;
     const std::vector<double>& getPhases() const;
     const std::vector<double>& getFrequencies() const;
@@ -42,6 +139,9 @@ private:
 
 public:
     StabilityAnalyzer();
+    // Restores already analysed values, e.g. from a session file
+    StabilityAnalyzer(const std::string& amplitudeMargin, const std::string& phaseMargin,
+        const std::string& phaseCrossoverFrequency, const std::string& gainCrossoverFrequency);
 
     // Analyse-Methode
     void analyze(const TransferFunction& transferFunction, const FrequencyResponse& frequencyResponse);
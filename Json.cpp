@@ -0,0 +1,300 @@
+#include "Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+// Recursive descent parser over the input text
+class JsonValue::Parser {
+public:
+    explicit Parser(const std::string& text)
+        : text(text), position(0), depth(0) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue();
+        skipWhitespace();
+        if (position != text.size()) {
+            fail("Unexpected characters after JSON value");
+        }
+        return value;
+    }
+
+private:
+    const std::string& text;
+    size_t position;
+    int depth;
+
+    // Nesting limit of arrays and objects, deeper input would overflow the stack
+    static constexpr int maxDepth = 64;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(message + " at position " + std::to_string(position));
+    }
+
+    void skipWhitespace() {
+        while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\r' || text[position] == '\n')) {
+            ++position;
+        }
+    }
+
+    bool consume(char expected) {
+        skipWhitespace();
+        if (position < text.size() && text[position] == expected) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char expected) {
+        if (!consume(expected)) {
+            fail(std::string("Expected '") + expected + "'");
+        }
+    }
+
+    bool consumeWord(const char* word) {
+        size_t length = std::char_traits<char>::length(word);
+        if (text.compare(position, length, word) == 0) {
+            position += length;
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue() {
+        skipWhitespace();
+        if (position >= text.size()) {
+            fail("Unexpected end of input");
+        }
+
+        JsonValue value;
+        char c = text[position];
+
+        if ((c == '{' || c == '[') && depth >= maxDepth) {
+            fail("Nesting too deep");
+        }
+
+        if (c == '{') {
+            ++position;
+            ++depth;
+            value.type = Type::Object;
+            if (!consume('}')) {
+                do {
+                    skipWhitespace();
+                    std::string key = parseString();
+                    expect(':');
+                    value.objectValue.emplace_back(std::move(key), parseValue());
+                } while (consume(','));
+                expect('}');
+            }
+            --depth;
+        }
+        else if (c == '[') {
+            ++position;
+            ++depth;
+            value.type = Type::Array;
+            if (!consume(']')) {
+                do {
+                    value.arrayValue.push_back(parseValue());
+                } while (consume(','));
+                expect(']');
+            }
+            --depth;
+        }
+        else if (c == '"') {
+            value.type = Type::String;
+            value.stringValue = parseString();
+        }
+        else if (consumeWord("true")) {
+            value.type = Type::Bool;
+            value.boolValue = true;
+        }
+        else if (consumeWord("false")) {
+            value.type = Type::Bool;
+            value.boolValue = false;
+        }
+        else if (consumeWord("null")) {
+            value.type = Type::Null;
+        }
+        else {
+            // strtod accepts a superset of JSON numbers, which is fine for a reader
+            const char* begin = text.c_str() + position;
+            char* end = nullptr;
+            value.numberValue = std::strtod(begin, &end);
+            if (end == begin) {
+                fail("Invalid value");
+            }
+            value.type = Type::Number;
+            position += static_cast<size_t>(end - begin);
+        }
+
+        return value;
+    }
+
+    std::string parseString() {
+        if (position >= text.size() || text[position] != '"') {
+            fail("Expected string");
+        }
+        ++position;
+
+        std::string result;
+        while (position < text.size() && text[position] != '"') {
+            char c = text[position++];
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (position >= text.size()) {
+                break;
+            }
+            char escaped = text[position++];
+            switch (escaped) {
+            case 'n': result += '\n'; break;
+            case 't': result += '\t'; break;
+            case 'r': result += '\r'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'u': {
+                // Only code points below 0x80 are needed by the protocol, others are replaced
+                if (position + 4 > text.size()) {
+                    fail("Invalid escape sequence");
+                }
+                unsigned long codePoint = std::strtoul(text.substr(position, 4).c_str(), nullptr, 16);
+                result += codePoint < 0x80 ? static_cast<char>(codePoint) : '?';
+                position += 4;
+                break;
+            }
+            default: result += escaped; break;
+            }
+        }
+
+        if (position >= text.size()) {
+            fail("Unterminated string");
+        }
+        ++position;
+        return result;
+    }
+};
+
+// JsonValue class implementation
+JsonValue::JsonValue()
+    : type(Type::Null), boolValue(false), numberValue(0.0) {}
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return Parser(text).parseDocument();
+}
+
+JsonValue::Type JsonValue::getType() const {
+    return type;
+}
+
+bool JsonValue::isNull() const {
+    return type == Type::Null;
+}
+
+bool JsonValue::isNumber() const {
+    return type == Type::Number;
+}
+
+bool JsonValue::isArray() const {
+    return type == Type::Array;
+}
+
+bool JsonValue::isObject() const {
+    return type == Type::Object;
+}
+
+bool JsonValue::asBool() const {
+    if (type != Type::Bool) {
+        throw std::runtime_error("Expected boolean");
+    }
+    return boolValue;
+}
+
+double JsonValue::asNumber() const {
+    if (type != Type::Number) {
+        throw std::runtime_error("Expected number");
+    }
+    return numberValue;
+}
+
+const std::string& JsonValue::asString() const {
+    if (type != Type::String) {
+        throw std::runtime_error("Expected string");
+    }
+    return stringValue;
+}
+
+const std::vector<JsonValue>& JsonValue::asArray() const {
+    if (type != Type::Array) {
+        throw std::runtime_error("Expected array");
+    }
+    return arrayValue;
+}
+
+std::vector<double> JsonValue::asNumberArray() const {
+    std::vector<double> values;
+    values.reserve(asArray().size());
+    for (const auto& element : arrayValue) {
+        values.push_back(element.asNumber());
+    }
+    return values;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    for (const auto& member : objectValue) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+void appendJsonString(std::string& output, const std::string& value)
+{
+    output += '"';
+    for (char c : value) {
+        switch (c) {
+        case '"': output += "\\\""; break;
+        case '\\': output += "\\\\"; break;
+        case '\n': output += "\\n"; break;
+        case '\r': output += "\\r"; break;
+        case '\t': output += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                output += buffer;
+            }
+            else {
+                output += c;
+            }
+        }
+    }
+    output += '"';
+}
+
+void appendJsonNumber(std::string& output, double value)
+{
+    if (!std::isfinite(value)) {
+        output += "null";
+        return;
+    }
+
+    // 17 significant digits are enough to read back the same double
+    char buffer[32];
+    int length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    output.append(buffer, static_cast<size_t>(length));
+}
+
+void appendJsonNumberArray(std::string& output, const std::vector<double>& values)
+{
+    output += '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            output += ',';
+        }
+        appendJsonNumber(output, values[i]);
+    }
+    output += ']';
+}
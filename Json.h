@@ -0,0 +1,49 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <vector>
+
+// JsonValue class
+// Small JSON reader for the line protocol of the compute server. Parse errors throw std::runtime_error.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue();
+
+    static JsonValue parse(const std::string& text);
+
+    Type getType() const;
+    bool isNull() const;
+    bool isNumber() const;
+    bool isArray() const;
+    bool isObject() const;
+
+    // Accessors throw std::runtime_error if the value has another type
+    bool asBool() const;
+    double asNumber() const;
+    const std::string& asString() const;
+    const std::vector<JsonValue>& asArray() const;
+    std::vector<double> asNumberArray() const;
+
+    // Member of an object, nullptr if missing or if this is no object
+    const JsonValue* find(const std::string& key) const;
+
+private:
+    class Parser;
+
+    Type type;
+    bool boolValue;
+    double numberValue;
+    std::string stringValue;
+    std::vector<JsonValue> arrayValue;
+    std::vector<std::pair<std::string, JsonValue>> objectValue;
+};
+
+// Helpers to write JSON text
+void appendJsonString(std::string& output, const std::string& value);
+void appendJsonNumber(std::string& output, double value);   // inf and NaN are written as null
+void appendJsonNumberArray(std::string& output, const std::vector<double>& values);
+
+#endif // JSON_H
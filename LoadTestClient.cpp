@@ -0,0 +1,175 @@
+#include "Json.h"
+#include "LocalSocket.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load test for the compute server. Usage:
+//   AppBodeLoadTest --socket <path> [--requests <n>] [--inflight <n>] [--order <n>] [--bode]
+// Keeps up to 'inflight' requests pipelined on one connection and reports the latency percentiles.
+int main(int argc, char* argv[])
+{
+    std::string socketPath;
+    int requestCount = 10000;
+    int maxInFlight = 64;
+    int order = 4;
+    bool includeBode = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+        else if (argument == "--requests" && i + 1 < argc) {
+            requestCount = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--inflight" && i + 1 < argc) {
+            maxInFlight = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--order" && i + 1 < argc) {
+            order = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (argument == "--bode") {
+            includeBode = true;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " --socket <path> [--requests <n>] [--inflight <n>] [--order <n>] [--bode]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (socketPath.empty()) {
+        std::cerr << "--socket is required" << std::endl;
+        return 1;
+    }
+
+    LocalSocket socket;
+    try
+    {
+        socket = LocalSocket::connect(socketPath);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    // Random stable systems: denominator is a product of (s + p) with p in 0.1 ... 1000
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> poleExponent(-1.0, 3.0);
+    std::vector<std::string> requests;
+    for (int r = 0; r < requestCount; ++r) {
+        std::vector<double> denominator = { 1.0 };
+        for (int k = 0; k < order; ++k) {
+            double pole = std::pow(10.0, poleExponent(generator));
+            std::vector<double> product(denominator.size() + 1, 0.0);
+            for (size_t i = 0; i < denominator.size(); ++i) {
+                product[i] += denominator[i];
+                product[i + 1] += denominator[i] * pole;
+            }
+            denominator = product;
+        }
+
+        std::string request = "{\"id\":" + std::to_string(r) + ",\"numerator\":[";
+        appendJsonNumber(request, denominator.back() * 10.0);
+        request += "],\"denominator\":";
+        appendJsonNumberArray(request, denominator);
+        request += includeBode ? ",\"bode\":true}\n" : ",\"bode\":false}\n";
+        requests.push_back(request);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<Clock::time_point> sendTimes(requestCount);
+    std::vector<double> latencies;
+    latencies.reserve(requestCount);
+
+    std::mutex mutex;
+    std::condition_variable slotFree;
+    int inFlight = 0;
+    int errors = 0;
+    bool readerDone = false;
+
+    // Reader: matches responses to requests by id
+    std::thread reader([&]() {
+        std::string line;
+        for (int received = 0; received < requestCount && socket.readLine(line); ++received) {
+            Clock::time_point now = Clock::now();
+            try
+            {
+                JsonValue response = JsonValue::parse(line);
+                const JsonValue* idValue = response.find("id");
+                int id = idValue && idValue->isNumber() ? static_cast<int>(idValue->asNumber()) : -1;
+                if (id < 0 || id >= requestCount) {
+                    throw std::runtime_error("Unknown id");
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (response.find("error")) {
+                    ++errors;
+                }
+                latencies.push_back(std::chrono::duration<double, std::micro>(now - sendTimes[id]).count());
+                --inFlight;
+            }
+            catch (const std::exception&)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++errors;
+                --inFlight;
+            }
+            slotFree.notify_one();
+        }
+
+        // Also wakes up the writer if the server closed the connection
+        std::lock_guard<std::mutex> lock(mutex);
+        readerDone = true;
+        slotFree.notify_one();
+        });
+
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < requestCount; ++r) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&]() { return inFlight < maxInFlight || readerDone; });
+            if (readerDone) {
+                break;
+            }
+            ++inFlight;
+            sendTimes[r] = Clock::now();
+        }
+        if (!socket.writeAll(requests[r])) {
+            std::cerr << "Connection closed by server" << std::endl;
+            break;
+        }
+    }
+
+    reader.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (latencies.empty()) {
+        std::cerr << "No responses received" << std::endl;
+        return 1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index];
+    };
+
+    std::cout << "Requests:   " << latencies.size() << " (" << errors << " errors)\n"
+        << "Throughput: " << latencies.size() / seconds << " requests/s\n"
+        << "p50:        " << percentile(0.50) << " us\n"
+        << "p99:        " << percentile(0.99) << " us\n"
+        << "max:        " << latencies.back() << " us" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "LocalSocket.h"
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+static const unsigned long long invalidHandle = INVALID_SOCKET;
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+static const int invalidHandle = -1;
+#endif
+
+#ifdef _WIN32
+// Winsock has to be started once per process
+static void initializeSockets()
+{
+    static bool initialized = false;
+    if (!initialized) {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+        initialized = true;
+    }
+}
+#else
+static void initializeSockets() {}
+#endif
+
+static sockaddr_un createAddress(const std::string& path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    return address;
+}
+
+// LocalSocket class implementation
+LocalSocket::LocalSocket()
+    : handle(invalidHandle) {}
+
+LocalSocket::LocalSocket(Handle handle)
+    : handle(handle) {}
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : handle(other.handle), readBuffer(std::move(other.readBuffer)), discardingLine(other.discardingLine) {
+    other.handle = invalidHandle;
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        handle = other.handle;
+        readBuffer = std::move(other.readBuffer);
+        discardingLine = other.discardingLine;
+        other.handle = invalidHandle;
+    }
+    return *this;
+}
+
+LocalSocket LocalSocket::listen(const std::string& path) {
+    initializeSockets();
+    sockaddr_un address = createAddress(path);
+
+#ifdef _WIN32
+    DeleteFileA(path.c_str());
+#else
+    unlink(path.c_str());
+#endif
+
+    LocalSocket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (!socket.isValid()) {
+        throw std::runtime_error("Could not create socket");
+    }
+    if (::bind(socket.handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Could not bind socket to " + path);
+    }
+    if (::listen(socket.handle, 16) != 0) {
+        throw std::runtime_error("Could not listen on " + path);
+    }
+
+    return socket;
+}
+
+LocalSocket LocalSocket::connect(const std::string& path) {
+    initializeSockets();
+    sockaddr_un address = createAddress(path);
+
+    LocalSocket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (!socket.isValid()) {
+        throw std::runtime_error("Could not create socket");
+    }
+    if (::connect(socket.handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Could not connect to " + path);
+    }
+
+    return socket;
+}
+
+LocalSocket LocalSocket::accept() {
+    return LocalSocket(::accept(handle, nullptr, nullptr));
+}
+
+bool LocalSocket::readLine(std::string& line, size_t maxLength) {
+    char buffer[65536];
+
+    while (true) {
+        size_t newline = readBuffer.find('\n');
+        if (discardingLine) {
+            // Rest of a too long line
+            if (newline == std::string::npos) {
+                readBuffer.clear();
+            }
+            else {
+                readBuffer.erase(0, newline + 1);
+                discardingLine = false;
+                continue;
+            }
+        }
+        else if (newline != std::string::npos && newline <= maxLength) {
+            line.assign(readBuffer, 0, newline);
+            readBuffer.erase(0, newline + 1);
+            return true;
+        }
+        else if (readBuffer.size() > maxLength) {
+            line.assign(readBuffer, 0, maxLength + 1);
+            readBuffer.erase(0, maxLength + 1);
+            discardingLine = true;
+            return true;
+        }
+
+        auto received = ::recv(handle, buffer, static_cast<int>(sizeof(buffer)), 0);
+        if (received <= 0) {
+            return false;
+        }
+        readBuffer.append(buffer, static_cast<size_t>(received));
+    }
+}
+
+bool LocalSocket::writeAll(const std::string& data) {
+    size_t sent = 0;
+
+    while (sent < data.size()) {
+#ifdef _WIN32
+        int result = ::send(handle, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+#else
+        ssize_t result = ::send(handle, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (result <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(result);
+    }
+
+    return true;
+}
+
+bool LocalSocket::isValid() const {
+    return handle != invalidHandle;
+}
+
+void LocalSocket::close() {
+    if (isValid()) {
+#ifdef _WIN32
+        ::closesocket(handle);
+#else
+        ::close(handle);
+#endif
+        handle = invalidHandle;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef LOCALSOCKET_H
+#define LOCALSOCKET_H
+
+#include <string>
+
+// LocalSocket class
+// Line based Unix domain socket (AF_UNIX). On Windows this needs Windows 10 1803 or newer.
+class LocalSocket {
+public:
+    LocalSocket();
+    ~LocalSocket();
+
+    LocalSocket(LocalSocket&& other) noexcept;
+    LocalSocket& operator=(LocalSocket&& other) noexcept;
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+
+    // Creates a listening socket at 'path'. An old socket file at this path is removed.
+    static LocalSocket listen(const std::string& path);
+
+    // Connects to a listening socket at 'path'
+    static LocalSocket connect(const std::string& path);
+
+    // Waits for the next client of a listening socket
+    LocalSocket accept();
+
+    // Reads up to the next '\n' (not included). Returns false when the connection was closed.
+    // At most maxLength + 1 characters of a line are kept, the rest of a longer line is dropped,
+    // so the caller recognizes it by its length without buffering it.
+    bool readLine(std::string& line, size_t maxLength = std::string::npos - 1);
+
+    // Sends all bytes. Returns false when the connection was closed.
+    bool writeAll(const std::string& data);
+
+    bool isValid() const;
+    void close();
+
+private:
+#ifdef _WIN32
+    using Handle = unsigned long long;   // SOCKET
+#else
+    using Handle = int;
+#endif
+    explicit LocalSocket(Handle handle);
+
+    Handle handle;
+    std::string readBuffer;
+    bool discardingLine = false;   // the start of a too long line was returned already
+};
+
+#endif // LOCALSOCKET_H
@@ -1,12 +1,16 @@
 #include "Orchestrator.h"
 #include "AppBodeDiagramm.h"
 #include "FunctionalClasses.h"
+#include "Profiler.h"
+#include "SessionFile.h"
 #include <sstream> 
 #include <string> 
 #include <vector> 
 #include <algorithm>
+#include <cctype>
 #include <cmath> 
 #include <regex>
+#include <stdexcept>
 
 std::vector<std::string> splitString(const std::string& input, char delimiter) {
     std::vector<std::string> tokens;
@@ -26,10 +30,248 @@ static void replaceAllChars(std::string& s, char oldChar, char newChar)
     std::replace(s.begin(), s.end(), oldChar, newChar);
 }
 
+// Builds the display string of a polynomial, highest power first
+static std::string formatPolynomial(const std::vector<double>& coefficients)
+{
+    std::string result;
+
+    // The highest exponent is (number_of_values - 1)
+    int power = static_cast<int>(coefficients.size()) - 1;
+
+    for (size_t i = 0; i < coefficients.size(); ++i)
+    {
+        double value = coefficients[i];
+
+        // Handle sign in the output string
+        if (!result.empty())
+        {
+            if (value < 0.0)
+                result += " - ";
+            else
+                result += " + ";
+        }
+        else
+        {
+            // For the very first term, if it's negative, just prepend "-"
+            if (value < 0.0)
+                result += "-";
+        }
+
+        // Use the absolute value here because we've already handled the sign
+        double absValue = std::fabs(value);
+        result += std::to_string(absValue);
+
+        // Append the exponent if needed
+        if (power > 1)
+        {
+            // Example: S^3
+            result += "S^" + std::to_string(power);
+        }
+        else if (power == 1)
+        {
+            // Example: S
+            result += "S";
+        }
+
+        // Decrement exponent for the next term
+        power--;
+    }
+
+    return result;
+}
+
+// Recursive descent parser for polynomials in s, e.g. "2(s+1)(s^2+2s+5)" or "(s+0,5)^3".
+// Juxtaposition and '*' multiply, '^' takes a non-negative integer exponent.
+// Throws std::invalid_argument on a syntax error.
+class PolynomialParser {
+public:
+    explicit PolynomialParser(const std::string& input) : input(input) {}
+
+    // Expanded polynomial and, if the input is a single product, its factors
+    std::vector<double> parse(std::vector<std::vector<double>>& factors) {
+        std::vector<double> result = parseSum(&factors);
+        skipSpaces();
+        if (position != input.size()) {
+            throw std::invalid_argument("unexpected '" + std::string(1, input[position]) + "'");
+        }
+        return result;
+    }
+
+private:
+    const std::string& input;
+    size_t position = 0;
+
+    void skipSpaces() {
+        while (position < input.size() && std::isspace(static_cast<unsigned char>(input[position]))) {
+            ++position;
+        }
+    }
+
+    bool accept(char character) {
+        skipSpaces();
+        if (position < input.size() && input[position] == character) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    bool startsFactor() {
+        skipSpaces();
+        return position < input.size()
+            && (input[position] == '(' || input[position] == 's' || input[position] == 'S' || input[position] == '.'
+                || std::isdigit(static_cast<unsigned char>(input[position])));
+    }
+
+    std::vector<double> parseSum(std::vector<std::vector<double>>* factors) {
+        std::vector<std::vector<double>> termFactors;
+        std::vector<double> result = parseTerm(termFactors);
+        bool singleTerm = true;
+
+        while (true) {
+            double sign = 1.0;
+            if (accept('+')) {
+                sign = 1.0;
+            }
+            else if (accept('-')) {
+                sign = -1.0;
+            }
+            else {
+                break;
+            }
+
+            std::vector<std::vector<double>> ignoredFactors;
+            std::vector<double> term = parseTerm(ignoredFactors);
+            for (double& value : term) {
+                value *= sign;
+            }
+            result = TransferFunction::addPolynomials(result, term);
+            singleTerm = false;
+        }
+
+        if (factors) {
+            *factors = singleTerm ? termFactors : std::vector<std::vector<double>>{ result };
+        }
+        return result;
+    }
+
+    // Product of factors, constant factors are collected into one gain in front
+    std::vector<double> parseTerm(std::vector<std::vector<double>>& factors) {
+        double gain = 1.0;
+        if (accept('-')) {
+            gain = -1.0;
+        }
+        else {
+            accept('+');
+        }
+
+        std::vector<double> result = { 1.0 };
+        do {
+            std::vector<double> base = parsePrimary();
+            int exponent = 1;
+            if (accept('^')) {
+                exponent = parseExponent();
+            }
+
+            for (int i = 0; i < exponent; ++i) {
+                if (base.size() == 1) {
+                    gain *= base[0];
+                }
+                else {
+                    factors.push_back(base);
+                    result = TransferFunction::multiplyPolynomials(result, base);
+                }
+            }
+        } while (accept('*') || startsFactor());
+
+        for (double& value : result) {
+            value *= gain;
+        }
+        if (gain != 1.0 || factors.empty()) {
+            factors.insert(factors.begin(), std::vector<double>{ gain });
+        }
+        return result;
+    }
+
+    std::vector<double> parsePrimary() {
+        if (accept('(')) {
+            std::vector<double> result = parseSum(nullptr);
+            if (!accept(')')) {
+                throw std::invalid_argument("missing ')'");
+            }
+            return result;
+        }
+        if (accept('s') || accept('S')) {
+            return { 1.0, 0.0 };
+        }
+
+        skipSpaces();
+        size_t begin = position;
+        while (position < input.size() && (std::isdigit(static_cast<unsigned char>(input[position])) || input[position] == '.' || input[position] == ',')) {
+            ++position;
+        }
+        if (begin == position) {
+            throw std::invalid_argument(position < input.size() ? "unexpected '" + std::string(1, input[position]) + "'" : "unexpected end");
+        }
+
+        // Replace commas with dots so std::stod can parse it
+        std::string number = input.substr(begin, position - begin);
+        replaceAllChars(number, ',', '.');
+        size_t parsedLength = 0;
+        double value = std::stod(number, &parsedLength);
+        if (parsedLength != number.size()) {
+            throw std::invalid_argument("invalid number '" + number + "'");
+        }
+        return { value };
+    }
+
+    int parseExponent() {
+        skipSpaces();
+        int exponent = 0;
+        size_t begin = position;
+        while (position < input.size() && std::isdigit(static_cast<unsigned char>(input[position]))) {
+            exponent = exponent * 10 + (input[position] - '0');
+            if (exponent > 1000) {
+                throw std::invalid_argument("exponent too large");
+            }
+            ++position;
+        }
+        if (begin == position) {
+            throw std::invalid_argument("missing exponent");
+        }
+        return exponent;
+    }
+};
+
 std::string Orchestrator::CreateTransferFunction(const std::string& input, std::vector<double>& coefficients)
 {
+    std::vector<std::vector<double>> factors;
+    return CreateTransferFunction(input, coefficients, factors);
+}
 
+std::string Orchestrator::CreateTransferFunction(const std::string& input, std::vector<double>& coefficients, std::vector<std::vector<double>>& factors)
+{
     coefficients.clear();
+    factors.clear();
+
+    // Expressions in s like "(s+1)(s^2+2s+5)", otherwise a plain list of coefficients
+    if (input.find_first_of("sS(") != std::string::npos)
+    {
+        try
+        {
+            PolynomialParser parser(input);
+            coefficients = parser.parse(factors);
+        }
+        catch (const std::exception& error)
+        {
+            // Syntax errors and numbers beyond double's range
+            coefficients.clear();
+            factors.clear();
+            return std::string("Invalid input: ") + error.what();
+        }
+
+        return formatPolynomial(coefficients);
+    }
 
     // A temporary vector to store all valid parsed values
     std::vector<double> parsedValues;
@@ -76,54 +318,31 @@ std::string Orchestrator::CreateTransferFunction(const std::string& input, std::
         }
     }
 
-    // Build the polynomial string from the parsed values
-    std::string result;
-
-    // The highest exponent is (number_of_values - 1)
-    int power = static_cast<int>(parsedValues.size()) - 1;
+    coefficients = parsedValues;
+    factors.push_back(coefficients);
 
-    for (size_t i = 0; i < parsedValues.size(); ++i)
-    {
-        double value = parsedValues[i];
-        // Store the value in the coefficients vector
-        coefficients.push_back(value);
-
-        // Handle sign in the output string
-        if (!result.empty())
-        {
-            if (value < 0.0)
-                result += " - ";
-            else
-                result += " + ";
-        }
-        else
-        {
-            // For the very first term, if it's negative, just prepend "-"
-            if (value < 0.0)
-                result += "-";
-        }
+    return formatPolynomial(coefficients);
+}
 
-        // Use the absolute value here because we've already handled the sign
-        double absValue = std::fabs(value);
-        result += std::to_string(absValue);
+double Orchestrator::ParseOptionalValue(const std::string& input, double defaultValue)
+{
+    std::string value = input;
+    replaceAllChars(value, ',', '.');
 
-        // Append the exponent if needed
-        if (power > 1)
-        {
-            // Example: S^3
-            result += "S^" + std::to_string(power);
-        }
-        else if (power == 1)
-        {
-            // Example: S
-            result += "S";
+    try
+    {
+        double parsed = std::stod(value);
+        // Only positive values are meaningful for frequencies and point counts
+        if (parsed > 0.0 && std::isfinite(parsed)) {
+            return parsed;
         }
-
-        // Decrement exponent for the next term
-        power--;
+    }
+    catch (const std::exception&)
+    {
+        // Empty or invalid input means automatic
     }
 
-    return result;
+    return defaultValue;
 }
 
 std::string Orchestrator::CreateDividerLength(const std::string& numeratorValue, const std::string& denominatorValue) {
@@ -131,57 +350,369 @@ std::string Orchestrator::CreateDividerLength(const std::string& numeratorValue,
     return std::string(maxLength, '-');
 }
 
+Orchestrator::Orchestrator() {
+    addSystem();
+}
+
 void Orchestrator::setGUIRef(AppBodeDiagramm& frameRef) {
     GUIRef = &frameRef;
+    refreshSystemList();
 }
 
-void Orchestrator::updateRecognizedFunction() {
-    // Get values from gui
-    std::string numerator = GUIRef->GetNumeratorBoxValue();
-    std::string denominator = GUIRef->GetDenominatorBoxValue();
-    
-    // Creat transfer function 
+void Orchestrator::refreshSystemList() {
+    if (!GUIRef) {
+        return;
+    }
+
+    std::vector<std::string> names;
+    std::vector<bool> visible;
+    for (const auto& system : systems) {
+        names.push_back(system.name);
+        visible.push_back(system.visible);
+    }
+    GUIRef->SetSystemList(names, visible, selectedSystem);
+}
+
+void Orchestrator::addSystem() {
+    SystemEntry system;
+    system.name = "System " + std::to_string(++systemCounter);
+    parseSystem(system);
+    systems.push_back(std::move(system));
+    selectSystem(static_cast<int>(systems.size()) - 1);
+}
+
+void Orchestrator::removeSystem(int index) {
+    // At least one system is always kept so the input boxes have something to edit
+    if (index < 0 || index >= static_cast<int>(systems.size()) || systems.size() == 1) {
+        return;
+    }
+
+    systems.erase(systems.begin() + index);
+    // The range of the removed system is no longer needed, covering results are kept
+    automaticSharedGrid = FrequencyGrid(0.0, 0.0, 0);
+    selectSystem(std::min(index, static_cast<int>(systems.size()) - 1));
+}
+
+void Orchestrator::selectSystem(int index) {
+    if (index < 0 || index >= static_cast<int>(systems.size())) {
+        return;
+    }
+
+    selectedSystem = index;
+    refreshSystemList();
+
+    if (GUIRef) {
+        GUIRef->SetNumeratorBoxValue(systems[selectedSystem].numeratorInput);
+        GUIRef->SetDenominatorBoxValue(systems[selectedSystem].denominatorInput);
+        updateRecognizedFunction();
+    }
+}
+
+void Orchestrator::setSystemVisible(int index, bool visible) {
+    if (index < 0 || index >= static_cast<int>(systems.size())) {
+        return;
+    }
+
+    systems[index].visible = visible;
+    updateRecognizedFunction();
+}
+
+// Products of several factors are evaluated factor by factor instead of the expanded polynomials
+static TransferFunction createFactoredTransferFunction(const std::vector<std::vector<double>>& numeratorFactors, const std::vector<std::vector<double>>& denominatorFactors,
+    const std::vector<double>& numeratorCoefficients, const std::vector<double>& denominatorCoefficients)
+{
+    if (numeratorFactors.size() <= 1 && denominatorFactors.size() <= 1) {
+        return TransferFunction(numeratorCoefficients, denominatorCoefficients);
+    }
+
+    TransferFunction result(numeratorFactors.empty() ? numeratorCoefficients : numeratorFactors[0],
+        denominatorFactors.empty() ? denominatorCoefficients : denominatorFactors[0]);
+    for (size_t i = 1; i < numeratorFactors.size(); ++i) {
+        result = TransferFunction::series(result, TransferFunction(numeratorFactors[i], { 1.0 }), TransferFunction::Composition::Factored);
+    }
+    for (size_t i = 1; i < denominatorFactors.size(); ++i) {
+        result = TransferFunction::series(result, TransferFunction({ 1.0 }, denominatorFactors[i]), TransferFunction::Composition::Factored);
+    }
+    return result;
+}
+
+void Orchestrator::parseSystem(SystemEntry& system) {
     std::vector<double> numeratorCoefficients;
     std::vector<double> denominatorCoefficients;
+    std::vector<std::vector<double>> numeratorFactors;
+    std::vector<std::vector<double>> denominatorFactors;
 
-    std::string recognizedNumerator = CreateTransferFunction(numerator, numeratorCoefficients);
-    std::string recognizedDenominator = CreateTransferFunction(denominator, denominatorCoefficients);
+    system.recognizedNumerator = CreateTransferFunction(system.numeratorInput, numeratorCoefficients, numeratorFactors);
+    system.recognizedDenominator = CreateTransferFunction(system.denominatorInput, denominatorCoefficients, denominatorFactors);
+    system.transferFunction = createFactoredTransferFunction(numeratorFactors, denominatorFactors, numeratorCoefficients, denominatorCoefficients);
+
+    if (numeratorCoefficients == system.numeratorCoefficients && denominatorCoefficients == system.denominatorCoefficients) {
+        return;
+    }
+
+    system.numeratorCoefficients = numeratorCoefficients;
+    system.denominatorCoefficients = denominatorCoefficients;
+    system.automaticGrid = FrequencyGrid::fromTransferFunction(system.transferFunction);
+    system.resultValid = false;
+    system.timeResultValid = false;
+}
+
+FrequencyGrid Orchestrator::createSharedGrid(std::string& rangeNote) {
+    // Union of the automatic ranges of all visible systems
+    double start = 0.0;
+    double end = 0.0;
+    double pointsPerDecade = 0.0;
+    for (const auto& system : systems) {
+        if (!system.visible) {
+            continue;
+        }
+        if (end == 0.0) {
+            start = system.automaticGrid.getStartFrequency();
+            end = system.automaticGrid.getEndFrequency();
+        }
+        start = std::min(start, system.automaticGrid.getStartFrequency());
+        end = std::max(end, system.automaticGrid.getEndFrequency());
+        pointsPerDecade = std::max(pointsPerDecade, double(system.automaticGrid.getPointsPerDecade()));
+    }
+
+    if (end == 0.0) {
+        const FrequencyGrid& selectedGrid = systems[selectedSystem].automaticGrid;
+        start = selectedGrid.getStartFrequency();
+        end = selectedGrid.getEndFrequency();
+        pointsPerDecade = selectedGrid.getPointsPerDecade();
+    }
+
+    // The automatic grid only grows, the density 6/damping changes with almost every input
+    if (automaticSharedGrid.getEndFrequency() > 0.0) {
+        start = std::min(start, automaticSharedGrid.getStartFrequency());
+        end = std::max(end, automaticSharedGrid.getEndFrequency());
+        pointsPerDecade = std::max(pointsPerDecade, double(automaticSharedGrid.getPointsPerDecade()));
+    }
+    automaticSharedGrid = FrequencyGrid(start, end, static_cast<int>(pointsPerDecade));
+
+    // 0 means automatic
+    double userStart = ParseOptionalValue(GUIRef->GetStartFrequencyBoxValue(), 0.0);
+    double userEnd = ParseOptionalValue(GUIRef->GetEndFrequencyBoxValue(), 0.0);
+    pointsPerDecade = ParseOptionalValue(GUIRef->GetPointsPerDecadeBoxValue(), pointsPerDecade);
+
+    pointsPerDecade = std::min(std::max(pointsPerDecade, 1.0), 100000.0);
+
+    // Same resolution as the compute server
+    return FrequencyGrid(start, end, static_cast<int>(pointsPerDecade)).withBounds(userStart, userEnd, rangeNote);
+}
+
+bool Orchestrator::coversGrid(const SystemEntry& system, const FrequencyGrid& grid) {
+    return system.resultValid
+        && system.resultStartFrequency <= grid.getStartFrequency()
+        && system.resultEndFrequency >= grid.getEndFrequency()
+        && system.resultPointsPerDecade >= grid.getPointsPerDecade();
+}
+
+void Orchestrator::updateRecognizedFunction() {
+    Profiler::instance().beginUpdate();
+    ScopedTimer updateTimer("Update");
+
+    // Get values from gui into the selected system
+    SystemEntry& selected = systems[selectedSystem];
+    selected.numeratorInput = GUIRef->GetNumeratorBoxValue();
+    selected.denominatorInput = GUIRef->GetDenominatorBoxValue();
+
+    // Creat transfer function 
+    {
+        ScopedTimer timer("Parse");
+        parseSystem(selected);
+    }
 
     // Set recognized transfer function to gui
-    GUIRef->SetRecognizedFunctionNominator(recognizedNumerator);
-    GUIRef->SetRecognizedFunctionDenominator(recognizedDenominator);
+    GUIRef->SetRecognizedFunctionNominator(selected.recognizedNumerator);
+    GUIRef->SetRecognizedFunctionDenominator(selected.recognizedDenominator);
 
     // Expand divider to cover whole function
-    std::string divider = CreateDividerLength(recognizedNumerator, recognizedDenominator);
+    std::string divider = CreateDividerLength(selected.recognizedNumerator, selected.recognizedDenominator);
     GUIRef->SetDivider(divider);
 
-    // Calculate Transferfunction values.
-    TransferFunction transferFunction(numeratorCoefficients, denominatorCoefficients);
+    // Shared sweep range of all visible systems
+    ScopedTimer gridTimer("Grid");
+    std::string rangeNote;
+    FrequencyGrid frequencyGrid = createSharedGrid(rangeNote);
+    GUIRef->SetFrequencyRangeInfo(frequencyGrid.getStartFrequency(), frequencyGrid.getEndFrequency(), frequencyGrid.getPointsPerDecade(), rangeNote);
+
+    // Only visible systems whose coefficients changed or whose results do not cover the grid are calculated again
+    std::vector<SystemEntry*> staleSystems;
+    std::vector<const TransferFunction*> batch;
+    for (auto& system : systems) {
+        if (system.visible && !coversGrid(system, frequencyGrid)) {
+            staleSystems.push_back(&system);
+            batch.push_back(&system.transferFunction);
+        }
+    }
+
+    auto frequencies = std::make_shared<const std::vector<double>>();
+    if (!staleSystems.empty()) {
+        frequencies = std::make_shared<const std::vector<double>>(frequencyGrid.createFrequencies());
+    }
+    gridTimer.stop();
 
-    std::vector<double> frequencies;
-    int numPoints = 10000;
-    double start = 0.01;
-    double end = 1000000;
+    // DO Analysis, all stale systems in one parallel pass
+    {
+        ScopedTimer timer("Frequency response");
+        std::vector<FrequencyResponse> responses = FrequencyResponse::computeBatch(frequencies, batch);
+        for (size_t i = 0; i < staleSystems.size(); ++i) {
+            staleSystems[i]->frequencyResponse = std::move(responses[i]);
+        }
+    }
 
-    // Generate 'numPoints' frequency values equally spaced on a log scale between 'start' and 'end'.
-    for (int i = 0; i < numPoints; ++i) {
-        double exponent = log10(start) + i * (log10(end) - log10(start)) / (numPoints - 1);
-        frequencies.push_back(pow(10, exponent));
+    {
+        ScopedTimer timer("Stability");
+        for (size_t i = 0; i < staleSystems.size(); ++i) {
+            SystemEntry& system = *staleSystems[i];
+            system.stabilityAnalyzer = StabilityAnalyzer();
+            system.stabilityAnalyzer.analyze(system.transferFunction, system.frequencyResponse);
+
+            system.resultValid = true;
+            system.resultStartFrequency = frequencyGrid.getStartFrequency();
+            system.resultEndFrequency = frequencyGrid.getEndFrequency();
+            system.resultPointsPerDecade = frequencyGrid.getPointsPerDecade();
+        }
     }
+    Profiler::instance().addCounter("Calculated systems", static_cast<long long>(staleSystems.size()));
 
-    // DO Analysis
-    FrequencyResponse frequencyResponse(frequencies);
-    frequencyResponse.compute(transferFunction);
+    // Step and impulse responses of visible systems whose coefficients changed
+    {
+        ScopedTimer timer("Time response");
+        std::vector<SystemEntry*> staleTimeSystems;
+        std::vector<const TransferFunction*> batch;
+        for (auto& system : systems) {
+            if (system.visible && !system.timeResultValid) {
+                staleTimeSystems.push_back(&system);
+                batch.push_back(&system.transferFunction);
+            }
+        }
 
-    StabilityAnalyzer stabilityAnalyzer;
-    stabilityAnalyzer.analyze(transferFunction, frequencyResponse);
+        std::vector<TimeResponse> responses = TimeResponse::computeBatch(batch);
+        for (size_t i = 0; i < staleTimeSystems.size(); ++i) {
+            SystemEntry& system = *staleTimeSystems[i];
+            system.timeResponse = std::move(responses[i]);
+            system.stepAnalyzer = StepAnalyzer();
+            system.stepAnalyzer.analyze(system.transferFunction, system.timeResponse);
+            system.timeResultValid = true;
+        }
+    }
+
+    // Collect visible systems for the plots and the margin table
+    std::vector<std::string> names;
+    std::vector<const std::vector<double>*> magnitudes;
+    std::vector<const std::vector<double>*> phases;
+    std::vector<const std::vector<double>*> responseTimes;
+    std::vector<const std::vector<double>*> responseValues;
+    const bool showImpulse = GUIRef->GetImpulseResponseBoxValue();
+    std::vector<std::vector<std::string>> marginRows;
+    std::vector<const std::vector<double>*> plotFrequencies;
+    for (const auto& system : systems) {
+        if (!system.visible) {
+            continue;
+        }
+        names.push_back(system.name);
+        magnitudes.push_back(&system.frequencyResponse.getMagnitudes());
+        phases.push_back(&system.frequencyResponse.getPhases());
+        plotFrequencies.push_back(&system.frequencyResponse.getFrequencies());
+        responseTimes.push_back(&system.timeResponse.getTimes());
+        responseValues.push_back(showImpulse ? &system.timeResponse.getImpulseValues() : &system.timeResponse.getStepValues());
+
+        const StabilityAnalyzer& stability = system.stabilityAnalyzer;
+        const StepAnalyzer& step = system.stepAnalyzer;
+        marginRows.push_back({ system.name, stability.getAmplitudeMargin(), stability.getPhaseMargin(),
+            stability.getPhaseCrossoverFrequency(), stability.getGainCrossoverFrequency(),
+            step.getOvershoot(), step.getRiseTime(), step.getSettlingTime(), step.getPeakTime(), step.getSteadyStateValue() });
+    }
 
     // Fill gui elements
-    GUIRef->CreateMagnitudePlot(frequencyResponse.getFrequencies(), frequencyResponse.getMagnitudes());
-    GUIRef->CreatePhasePlot(frequencyResponse.getFrequencies(), frequencyResponse.getPhases());
-    GUIRef->UpdateAmplitudeMargin(stabilityAnalyzer.getAmplitudeMargin());
-    GUIRef->UpdatePhaseMargin(stabilityAnalyzer.getPhaseMargin());
-    GUIRef->UpdatePhaseCrossoverFrequency(stabilityAnalyzer.getPhaseCrossoverFrequency());
-    GUIRef->UpdateGainCrossoverFrequency(stabilityAnalyzer.getGainCrossoverFrequency());
+    {
+        ScopedTimer timer("Magnitude plot");
+        GUIRef->CreateMagnitudePlot(frequencyGrid.getStartFrequency(), frequencyGrid.getEndFrequency(), names, plotFrequencies, magnitudes);
+    }
+    {
+        ScopedTimer timer("Phase plot");
+        GUIRef->CreatePhasePlot(frequencyGrid.getStartFrequency(), frequencyGrid.getEndFrequency(), names, plotFrequencies, phases);
+    }
+    {
+        ScopedTimer timer("Time response plot");
+        GUIRef->CreateTimeResponsePlot(showImpulse ? "Impulse Response" : "Step Response", names, responseTimes, responseValues);
+    }
+    GUIRef->UpdateMarginTable(marginRows);
+
+    // The labels show the margins of the selected system
+    const StabilityAnalyzer& selectedStability = selected.visible && selected.resultValid ? selected.stabilityAnalyzer : StabilityAnalyzer();
+    GUIRef->UpdateAmplitudeMargin(selectedStability.getAmplitudeMargin());
+    GUIRef->UpdatePhaseMargin(selectedStability.getPhaseMargin());
+    GUIRef->UpdatePhaseCrossoverFrequency(selectedStability.getPhaseCrossoverFrequency());
+    GUIRef->UpdateGainCrossoverFrequency(selectedStability.getGainCrossoverFrequency());
+
+    // Show timing breakdown of this update
+    updateTimer.stop();
+    GUIRef->UpdateTimingInfo(Profiler::instance().getLastUpdateSummary());
+}
+
+bool Orchestrator::saveSession(const std::string& filePath, std::string& errorMessage) {
+    SessionSettings settings;
+    settings.startFrequencyInput = GUIRef->GetStartFrequencyBoxValue();
+    settings.endFrequencyInput = GUIRef->GetEndFrequencyBoxValue();
+    settings.pointsPerDecadeInput = GUIRef->GetPointsPerDecadeBoxValue();
+    settings.selectedSystem = selectedSystem;
+
+    try
+    {
+        ScopedTimer timer("Save session");
+        SessionFile::save(filePath, systems, settings);
+    }
+    catch (const std::exception& error)
+    {
+        errorMessage = error.what();
+        return false;
+    }
+
+    return true;
+}
+
+bool Orchestrator::loadSession(const std::string& filePath, std::string& errorMessage) {
+    SessionSettings settings;
+    std::vector<SystemEntry> loadedSystems;
+
+    try
+    {
+        ScopedTimer timer("Load session");
+        loadedSystems = SessionFile::load(filePath, settings);
+    }
+    catch (const std::exception& error)
+    {
+        errorMessage = error.what();
+        return false;
+    }
+
+    if (loadedSystems.empty()) {
+        errorMessage = "The session contains no systems.";
+        return false;
+    }
+
+    systems = std::move(loadedSystems);
+    automaticSharedGrid = FrequencyGrid(0.0, 0.0, 0);
+    systemCounter = static_cast<int>(systems.size());
+
+    // The file only stores the expanded coefficients, unchanged coefficients keep their results.
+    // Time responses are not stored, the update simulates them again.
+    // The automatic grid is always derived again instead of trusting the file.
+    for (auto& system : systems) {
+        parseSystem(system);
+        system.automaticGrid = FrequencyGrid::fromTransferFunction(system.transferFunction);
+    }
+
+    // Results that do not cover the grid of these settings are calculated again by the update
+    GUIRef->SetFrequencyRangeBoxValues(settings.startFrequencyInput, settings.endFrequencyInput, settings.pointsPerDecadeInput);
+    selectSystem(std::min(std::max(settings.selectedSystem, 0), static_cast<int>(systems.size()) - 1));
+
+    return true;
+}
 
+bool Orchestrator::exportTimingTrace(const std::string& filePath) {
+    return Profiler::instance().writeChromeTrace(filePath);
 }
@@ -1,27 +1,98 @@
 #ifndef ORCHESTRATOR_H
 #define ORCHESTRATOR_H
 
+#include "FunctionalClasses.h"
+#include "TimeResponse.h"
 #include <string>
 #include <vector>
 
 class AppBodeDiagramm;
 
+// One transfer function of the overlay together with its cached results
+struct SystemEntry {
+    std::string name;
+    std::string numeratorInput = "1";
+    std::string denominatorInput = "1";
+    bool visible = true;
+
+    std::vector<double> numeratorCoefficients;
+    std::vector<double> denominatorCoefficients;
+    std::string recognizedNumerator;
+    std::string recognizedDenominator;
+    TransferFunction transferFunction = TransferFunction({ 1.0 }, { 1.0 });
+    FrequencyGrid automaticGrid = FrequencyGrid(0.01, 100.0, 200);
+
+    // Results stay valid until the coefficients change or the grid is no longer covered
+    bool resultValid = false;
+    double resultStartFrequency = 0.0;
+    double resultEndFrequency = 0.0;
+    int resultPointsPerDecade = 0;
+    FrequencyResponse frequencyResponse = FrequencyResponse(std::make_shared<const std::vector<double>>());
+    StabilityAnalyzer stabilityAnalyzer;
+
+    // Time responses only depend on the coefficients
+    bool timeResultValid = false;
+    TimeResponse timeResponse;
+    StepAnalyzer stepAnalyzer;
+};
+
 class Orchestrator {
 public:
+    Orchestrator();
+
     // Sets the reference to the GUI frame
     void setGUIRef(AppBodeDiagramm& frameRef);
 
     // Updates the recognized function based on GUI input
     void updateRecognizedFunction();
 
-    // Creates a transfer function from the input string
+    // Management of the overlaid systems. The numerator/denominator boxes edit the selected system.
+    void addSystem();
+    void removeSystem(int index);
+    void selectSystem(int index);
+    void setSystemVisible(int index, bool visible);
+
+    // Creates a transfer function from the input string. Accepts a list of coefficients ("1 2 5")
+    // or an expression in s ("2(s+1)(s^2+2s+5)"); 'factors' receives the factors of a product.
     std::string CreateTransferFunction(const std::string& input, std::vector<double>& coefficients);
+    std::string CreateTransferFunction(const std::string& input, std::vector<double>& coefficients, std::vector<std::vector<double>>& factors);
+
+    // Parses a positive number from an optional input box, returns defaultValue if empty or invalid
+    double ParseOptionalValue(const std::string& input, double defaultValue);
 
     // Creates a divider line for display purposes
     std::string CreateDividerLength(const std::string& numeratorValue, const std::string& denominatorValue);
 
+    // Session files with systems, frequency range settings and computed results.
+    // Return false and set errorMessage if the file could not be written or read.
+    bool saveSession(const std::string& filePath, std::string& errorMessage);
+    bool loadSession(const std::string& filePath, std::string& errorMessage);
+
+    // Writes the recorded pipeline timings as Chrome trace-event JSON
+    bool exportTimingTrace(const std::string& filePath);
+
 private:
+    // Parses the inputs of a system and invalidates its results if the coefficients changed
+    void parseSystem(SystemEntry& system);
+
+    // Common frequency grid of all visible systems, user values override the automatic ones.
+    // rangeNote describes a bound that had to be replaced, empty otherwise.
+    FrequencyGrid createSharedGrid(std::string& rangeNote);
+
+    // True if the results of the system span 'grid' with at least its density, they are shown without a new sweep
+    static bool coversGrid(const SystemEntry& system, const FrequencyGrid& grid);
+
+    // Sends names, visibility and selection of the systems to the GUI
+    void refreshSystemList();
+
     AppBodeDiagramm* GUIRef = nullptr;
+
+    std::vector<SystemEntry> systems;
+    // Automatic part of the shared grid. It only grows while systems are edited, so a new range
+    // or density of one system does not invalidate the results of all others.
+    FrequencyGrid automaticSharedGrid = FrequencyGrid(0.0, 0.0, 0);
+    int selectedSystem = 0;
+    int systemCounter = 0;
 };
 
 #endif // ORCHESTRATOR_H
@@ -0,0 +1,161 @@
+#include "Profiler.h"
+#include <cstdio>
+#include <fstream>
+
+// Profiler class implementation
+Profiler::Profiler()
+    : sessionStart(std::chrono::steady_clock::now()) {}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::beginUpdate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lastUpdateTimings.clear();
+    lastUpdateCounters.clear();
+}
+
+long long Profiler::toMicroseconds(std::chrono::steady_clock::time_point timePoint) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(timePoint - sessionStart).count();
+}
+
+// Chrome trace wants small integer thread ids, so the std::thread::id is mapped. Must be called with the mutex held.
+unsigned int Profiler::currentThreadId() {
+    auto inserted = threadIds.emplace(std::this_thread::get_id(), static_cast<unsigned int>(threadIds.size() + 1));
+    return inserted.first->second;
+}
+
+void Profiler::recordEvent(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Timers with the same name are summed up (e.g. one per displayed system)
+    bool found = false;
+    for (auto& timing : lastUpdateTimings) {
+        if (timing.first == name) {
+            timing.second += milliseconds;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        lastUpdateTimings.emplace_back(name, milliseconds);
+    }
+
+    if (sessionEvents.size() < maxSessionEvents) {
+        long long startMicroseconds = toMicroseconds(start);
+        sessionEvents.push_back({ name, startMicroseconds, toMicroseconds(end) - startMicroseconds, currentThreadId() });
+    }
+}
+
+void Profiler::addCounter(const char* name, long long value) {
+    long long timestamp = toMicroseconds(std::chrono::steady_clock::now());
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    long long total = value;
+    bool found = false;
+    for (auto& counter : lastUpdateCounters) {
+        if (counter.first == name) {
+            counter.second += value;
+            total = counter.second;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        lastUpdateCounters.emplace_back(name, value);
+    }
+
+    if (sessionCounters.size() < maxSessionEvents) {
+        sessionCounters.push_back({ name, timestamp, total });
+    }
+}
+
+std::string Profiler::getLastUpdateSummary() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string summary;
+    char buffer[128];
+
+    for (const auto& timing : lastUpdateTimings) {
+        if (!summary.empty()) {
+            summary += " | ";
+        }
+        std::snprintf(buffer, sizeof(buffer), "%s %.2f ms", timing.first.c_str(), timing.second);
+        summary += buffer;
+    }
+
+    for (const auto& counter : lastUpdateCounters) {
+        if (!summary.empty()) {
+            summary += " | ";
+        }
+        summary += counter.first + " " + std::to_string(counter.second);
+    }
+
+    return summary;
+}
+
+// Escapes quotes and backslashes so names can be written into JSON strings
+static std::string escapeJson(const std::string& value)
+{
+    std::string result;
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filePath) const {
+    std::ofstream file(filePath);
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Complete events ("X") for the timers and counter events ("C") for the counters
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& event : sessionEvents) {
+        file << (first ? "" : ",\n")
+            << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"pipeline\",\"ph\":\"X\""
+            << ",\"ts\":" << event.startMicroseconds << ",\"dur\":" << event.durationMicroseconds
+            << ",\"pid\":1,\"tid\":" << event.threadId << "}";
+        first = false;
+    }
+    for (const auto& counter : sessionCounters) {
+        file << (first ? "" : ",\n")
+            << "{\"name\":\"" << escapeJson(counter.name) << "\",\"ph\":\"C\",\"ts\":" << counter.timestampMicroseconds
+            << ",\"pid\":1,\"args\":{\"value\":" << counter.value << "}}";
+        first = false;
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(file);
+}
+
+// ScopedTimer class implementation
+ScopedTimer::ScopedTimer(const char* name)
+    : name(name) {
+    // The profiler takes the session start on first use, it has to exist before 'start' is taken
+    Profiler::instance();
+    start = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() {
+    stop();
+}
+
+void ScopedTimer::stop() {
+    if (!stopped) {
+        Profiler::instance().recordEvent(name, start, std::chrono::steady_clock::now());
+        stopped = true;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Profiler class
+// Collects timings of the calculation pipeline and a few counters. The timings of the
+// last update are kept for the status bar, all events of the session can be written
+// as Chrome trace-event JSON (load it in chrome://tracing or Perfetto).
+class Profiler {
+public:
+    struct TraceEvent {
+        std::string name;
+        long long startMicroseconds;
+        long long durationMicroseconds;
+        unsigned int threadId;
+    };
+
+    struct CounterSample {
+        std::string name;
+        long long timestampMicroseconds;
+        long long value;
+    };
+
+    static Profiler& instance();
+
+    // Starts a new update. The breakdown of the previous update is discarded.
+    void beginUpdate();
+
+    // Records a finished timer. Called by ScopedTimer.
+    void recordEvent(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    // Adds a value to a counter of the current update (e.g. evaluated points). "Buffer allocations"
+    // counts the grid, scratch and result vectors of the frequency and time responses only.
+    void addCounter(const char* name, long long value);
+
+    // Short text like "Parse 0.1 ms | Compute 2.3 ms | ..." for the last update
+    std::string getLastUpdateSummary() const;
+
+    // Writes all events of the session as Chrome trace-event JSON. Returns false if the file could not be written.
+    bool writeChromeTrace(const std::string& filePath) const;
+
+private:
+    Profiler();
+    long long toMicroseconds(std::chrono::steady_clock::time_point timePoint) const;
+    unsigned int currentThreadId();
+
+    mutable std::mutex mutex;
+    std::chrono::steady_clock::time_point sessionStart;
+
+    // Events and counters of the last update in recording order
+    std::vector<std::pair<std::string, double>> lastUpdateTimings;
+    std::vector<std::pair<std::string, long long>> lastUpdateCounters;
+
+    // Events of the whole session, limited so a long session can not grow without bound
+    std::vector<TraceEvent> sessionEvents;
+    std::vector<CounterSample> sessionCounters;
+    static const size_t maxSessionEvents = 200000;
+
+    std::map<std::thread::id, unsigned int> threadIds;
+};
+
+// Measures the time between construction and destruction and hands it to the profiler
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name);
+    ~ScopedTimer();
+
+    // Ends the measurement before the end of the scope
+    void stop();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+    bool stopped = false;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,60 @@
+#include "ComputeServer.h"
+#include "Profiler.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Compute server without GUI. Usage:
+//   AppBodeServer [--socket <path>] [--threads <n>] [--trace <file>]
+// Without --socket requests are read from stdin and answered on stdout.
+int main(int argc, char* argv[])
+{
+    std::string socketPath;
+    std::string traceFilePath;
+    unsigned int threadCount = std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+        else if (argument == "--threads" && i + 1 < argc) {
+            threadCount = static_cast<unsigned int>(std::atoi(argv[++i]));
+        }
+        else if (argument == "--trace" && i + 1 < argc) {
+            traceFilePath = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--socket <path>] [--threads <n>] [--trace <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    ComputeServer server(threadCount);
+
+    try
+    {
+        if (socketPath.empty()) {
+            server.serveStream(std::cin, std::cout);
+        }
+        else {
+            std::cerr << "Listening on " << socketPath << std::endl;
+            server.serveSocket(socketPath);
+        }
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+
+    // Only reached in stdin mode, the socket mode runs until the process is terminated
+    if (!traceFilePath.empty()) {
+        Profiler::instance().writeChromeTrace(traceFilePath);
+    }
+
+    return 0;
+}
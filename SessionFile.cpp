@@ -0,0 +1,356 @@
+#include "SessionFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// MappedFile class implementation
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    mappingHandle = size > 0 ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    data = mappingHandle ? static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!data) {
+        if (mappingHandle) {
+            CloseHandle(mappingHandle);
+        }
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Could not map " + path);
+    }
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Could not open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fileDescriptor, &status) != 0 || status.st_size <= 0) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Could not map " + path);
+    }
+    size = static_cast<size_t>(status.st_size);
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Could not map " + path);
+    }
+    data = static_cast<const unsigned char*>(mapping);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+#else
+    ::munmap(const_cast<unsigned char*>(data), size);
+    ::close(fileDescriptor);
+#endif
+}
+
+const unsigned char* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+// Binary layout, all offsets are counted from the start of the file
+namespace {
+
+struct StringRef {
+    uint64_t offset;
+    uint64_t length;
+};
+
+struct ArrayRef {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t systemCount;
+    uint32_t selectedSystem;
+    uint32_t reserved;
+    StringRef startFrequencyInput;
+    StringRef endFrequencyInput;
+    StringRef pointsPerDecadeInput;
+};
+
+struct SystemRecord {
+    StringRef name;
+    StringRef numeratorInput;
+    StringRef denominatorInput;
+    StringRef recognizedNumerator;
+    StringRef recognizedDenominator;
+    ArrayRef numerator;
+    ArrayRef denominator;
+    double automaticStartFrequency;         // informational, recomputed on load
+    double automaticEndFrequency;
+    int32_t automaticPointsPerDecade;
+    uint32_t visible;
+
+    // Cached results, only valid if hasResult != 0 and cacheKey matches
+    uint32_t hasResult;
+    int32_t resultPointsPerDecade;
+    double resultStartFrequency;
+    double resultEndFrequency;
+    uint64_t cacheKey;
+    ArrayRef frequencies;
+    ArrayRef magnitudes;
+    ArrayRef phases;
+    StringRef amplitudeMargin;
+    StringRef phaseMargin;
+    StringRef phaseCrossoverFrequency;
+    StringRef gainCrossoverFrequency;
+};
+
+static_assert(std::is_trivially_copyable<FileHeader>::value && std::is_trivially_copyable<SystemRecord>::value,
+    "Session records are copied byte by byte");
+
+const char sessionMagic[8] = { 'B', 'O', 'D', 'E', 'S', 'E', 'S', 'S' };
+
+// Collects the data section of a file that is written
+class SessionWriter {
+public:
+    explicit SessionWriter(size_t dataStart)
+        : buffer(dataStart, '\0') {}
+
+    StringRef addString(const std::string& value) {
+        StringRef ref = { buffer.size(), value.size() };
+        buffer += value;
+        return ref;
+    }
+
+    ArrayRef addArray(const std::vector<double>& values) {
+        // Arrays are 8 byte aligned so a mapping could also be read in place
+        buffer.resize((buffer.size() + 7) / 8 * 8, '\0');
+        ArrayRef ref = { buffer.size(), values.size() };
+        buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+        return ref;
+    }
+
+    template <typename T>
+    void writeAt(size_t offset, const T& value) {
+        std::memcpy(&buffer[offset], &value, sizeof(T));
+    }
+
+    const std::string& getBuffer() const {
+        return buffer;
+    }
+
+private:
+    std::string buffer;
+};
+
+// Reads from the mapped file, every reference is checked against the file size
+class SessionReader {
+public:
+    explicit SessionReader(const MappedFile& file)
+        : data(file.getData()), size(file.getSize()) {}
+
+    template <typename T>
+    T readAt(uint64_t offset) const {
+        check(offset, sizeof(T));
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+
+    std::string getString(const StringRef& ref) const {
+        check(ref.offset, ref.length);
+        return std::string(reinterpret_cast<const char*>(data + ref.offset), static_cast<size_t>(ref.length));
+    }
+
+    std::vector<double> getArray(const ArrayRef& ref) const {
+        const double* values = getArrayData(ref);
+        return std::vector<double>(values, values + ref.count);
+    }
+
+    const double* getArrayData(const ArrayRef& ref) const {
+        if (ref.count > size / sizeof(double)) {
+            throw std::runtime_error("Session file is damaged");
+        }
+        check(ref.offset, ref.count * sizeof(double));
+        return reinterpret_cast<const double*>(data + ref.offset);
+    }
+
+private:
+    void check(uint64_t offset, uint64_t length) const {
+        if (offset > size || length > size - offset) {
+            throw std::runtime_error("Session file is damaged");
+        }
+    }
+
+    const unsigned char* data;
+    size_t size;
+};
+
+// FNV-1a
+uint64_t hashBytes(uint64_t hash, const void* bytes, size_t length)
+{
+    const unsigned char* data = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+uint64_t SessionFile::computeCacheKey(const SystemEntry& system) {
+    uint64_t hash = 14695981039346656037ULL;
+    uint32_t version = calculationVersion;
+    hash = hashBytes(hash, &version, sizeof(version));
+
+    uint64_t numeratorCount = system.numeratorCoefficients.size();
+    hash = hashBytes(hash, &numeratorCount, sizeof(numeratorCount));
+    hash = hashBytes(hash, system.numeratorCoefficients.data(), system.numeratorCoefficients.size() * sizeof(double));
+    hash = hashBytes(hash, system.denominatorCoefficients.data(), system.denominatorCoefficients.size() * sizeof(double));
+
+    hash = hashBytes(hash, &system.resultStartFrequency, sizeof(double));
+    hash = hashBytes(hash, &system.resultEndFrequency, sizeof(double));
+    hash = hashBytes(hash, &system.resultPointsPerDecade, sizeof(int));
+
+    return hash;
+}
+
+void SessionFile::save(const std::string& path, const std::vector<SystemEntry>& systems, const SessionSettings& settings) {
+    const size_t recordStart = sizeof(FileHeader);
+    SessionWriter writer(recordStart + systems.size() * sizeof(SystemRecord));
+
+    FileHeader header = {};
+    std::memcpy(header.magic, sessionMagic, sizeof(sessionMagic));
+    header.version = currentVersion;
+    header.systemCount = static_cast<uint32_t>(systems.size());
+    header.selectedSystem = static_cast<uint32_t>(settings.selectedSystem);
+    header.startFrequencyInput = writer.addString(settings.startFrequencyInput);
+    header.endFrequencyInput = writer.addString(settings.endFrequencyInput);
+    header.pointsPerDecadeInput = writer.addString(settings.pointsPerDecadeInput);
+    writer.writeAt(0, header);
+
+    for (size_t i = 0; i < systems.size(); ++i) {
+        const SystemEntry& system = systems[i];
+
+        SystemRecord record = {};
+        record.name = writer.addString(system.name);
+        record.numeratorInput = writer.addString(system.numeratorInput);
+        record.denominatorInput = writer.addString(system.denominatorInput);
+        record.recognizedNumerator = writer.addString(system.recognizedNumerator);
+        record.recognizedDenominator = writer.addString(system.recognizedDenominator);
+        record.numerator = writer.addArray(system.numeratorCoefficients);
+        record.denominator = writer.addArray(system.denominatorCoefficients);
+        record.automaticStartFrequency = system.automaticGrid.getStartFrequency();
+        record.automaticEndFrequency = system.automaticGrid.getEndFrequency();
+        record.automaticPointsPerDecade = system.automaticGrid.getPointsPerDecade();
+        record.visible = system.visible ? 1 : 0;
+
+        if (system.resultValid) {
+            const FrequencyResponse& response = system.frequencyResponse;
+            const StabilityAnalyzer& stability = system.stabilityAnalyzer;
+
+            record.hasResult = 1;
+            record.resultPointsPerDecade = system.resultPointsPerDecade;
+            record.resultStartFrequency = system.resultStartFrequency;
+            record.resultEndFrequency = system.resultEndFrequency;
+            record.cacheKey = computeCacheKey(system);
+            record.frequencies = writer.addArray(response.getFrequencies());
+            record.magnitudes = writer.addArray(response.getMagnitudes());
+            record.phases = writer.addArray(response.getPhases());
+            record.amplitudeMargin = writer.addString(stability.getAmplitudeMargin());
+            record.phaseMargin = writer.addString(stability.getPhaseMargin());
+            record.phaseCrossoverFrequency = writer.addString(stability.getPhaseCrossoverFrequency());
+            record.gainCrossoverFrequency = writer.addString(stability.getGainCrossoverFrequency());
+        }
+
+        writer.writeAt(recordStart + i * sizeof(SystemRecord), record);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(writer.getBuffer().data(), static_cast<std::streamsize>(writer.getBuffer().size()));
+    if (!file) {
+        throw std::runtime_error("Could not write " + path);
+    }
+}
+
+std::vector<SystemEntry> SessionFile::load(const std::string& path, SessionSettings& settings) {
+    MappedFile file(path);
+    SessionReader reader(file);
+
+    FileHeader header = reader.readAt<FileHeader>(0);
+    if (std::memcmp(header.magic, sessionMagic, sizeof(sessionMagic)) != 0) {
+        throw std::runtime_error(path + " is no session file");
+    }
+    if (header.version != currentVersion) {
+        throw std::runtime_error("Unsupported session version " + std::to_string(header.version));
+    }
+
+    settings.startFrequencyInput = reader.getString(header.startFrequencyInput);
+    settings.endFrequencyInput = reader.getString(header.endFrequencyInput);
+    settings.pointsPerDecadeInput = reader.getString(header.pointsPerDecadeInput);
+    settings.selectedSystem = static_cast<int>(header.selectedSystem);
+
+    if (header.systemCount > (file.getSize() - sizeof(FileHeader)) / sizeof(SystemRecord)) {
+        throw std::runtime_error("Session file is damaged");
+    }
+
+    std::vector<SystemEntry> systems(header.systemCount);
+    for (size_t i = 0; i < systems.size(); ++i) {
+        SystemRecord record = reader.readAt<SystemRecord>(sizeof(FileHeader) + i * sizeof(SystemRecord));
+        SystemEntry& system = systems[i];
+
+        system.name = reader.getString(record.name);
+        system.numeratorInput = reader.getString(record.numeratorInput);
+        system.denominatorInput = reader.getString(record.denominatorInput);
+        system.recognizedNumerator = reader.getString(record.recognizedNumerator);
+        system.recognizedDenominator = reader.getString(record.recognizedDenominator);
+        system.numeratorCoefficients = reader.getArray(record.numerator);
+        system.denominatorCoefficients = reader.getArray(record.denominator);
+        system.visible = record.visible != 0;
+
+        if (!record.hasResult) {
+            continue;
+        }
+
+        system.resultStartFrequency = record.resultStartFrequency;
+        system.resultEndFrequency = record.resultEndFrequency;
+        system.resultPointsPerDecade = record.resultPointsPerDecade;
+        if (computeCacheKey(system) != record.cacheKey
+            || record.magnitudes.count != record.frequencies.count || record.phases.count != record.frequencies.count) {
+            continue;   // calculated again on the next update
+        }
+
+        system.frequencyResponse = FrequencyResponse(reader.getArrayData(record.frequencies), reader.getArrayData(record.magnitudes),
+            reader.getArrayData(record.phases), static_cast<size_t>(record.frequencies.count));
+        system.stabilityAnalyzer = StabilityAnalyzer(reader.getString(record.amplitudeMargin), reader.getString(record.phaseMargin),
+            reader.getString(record.phaseCrossoverFrequency), reader.getString(record.gainCrossoverFrequency));
+        system.resultValid = true;
+    }
+
+    return systems;
+}
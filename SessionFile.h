@@ -0,0 +1,69 @@
+#ifndef SESSIONFILE_H
+#define SESSIONFILE_H
+
+#include "Orchestrator.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// MappedFile class
+// Read-only memory mapping of a whole file. Throws std::runtime_error if the file can not be mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* getData() const;
+    size_t getSize() const;
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
+
+// Settings of the session besides the systems
+struct SessionSettings {
+    std::string startFrequencyInput;
+    std::string endFrequencyInput;
+    std::string pointsPerDecadeInput;
+    int selectedSystem = 0;
+};
+
+// SessionFile class
+// Versioned binary session: a header, one fixed size record per system and a data section with
+// strings and double arrays (8 byte aligned, native little endian). Loading maps the file and
+// copies the arrays block by block into the results, nothing is parsed or recomputed. The copy is
+// deliberate: the results own their arrays and the mapping is closed after loading, so the same
+// file can be saved again (Windows does not allow writing a mapped file).
+// The automatic grid is not taken from the file, it is derived from the coefficients again.
+// Step and impulse responses are not stored. They are simulated again after loading, which is
+// bounded by TimeResponse::maxOrder (well below 0.1 s per system, systems run in parallel).
+// Errors (missing file, wrong version, truncated data) throw std::runtime_error.
+class SessionFile {
+public:
+    static void save(const std::string& path, const std::vector<SystemEntry>& systems, const SessionSettings& settings);
+    static std::vector<SystemEntry> load(const std::string& path, SessionSettings& settings);
+
+    // Hash over coefficients and grid of a stored result. Results whose key does not match are
+    // dropped on load, so they are calculated again.
+    static uint64_t computeCacheKey(const SystemEntry& system);
+
+    // Version of the file layout
+    static constexpr uint32_t currentVersion = 1;
+
+    // Version of the calculation, part of the cache key. Increase it when results of
+    // FrequencyResponse or StabilityAnalyzer change for the same input.
+    static constexpr uint32_t calculationVersion = 2;
+};
+
+#endif // SESSIONFILE_H
@@ -0,0 +1,639 @@
+#include "TimeResponse.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+// Square matrices are stored row by row in a std::vector<double>
+static std::vector<double> multiplyMatrices(const std::vector<double>& a, const std::vector<double>& b, size_t n)
+{
+    std::vector<double> result(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < n; ++k) {
+            double aik = a[i * n + k];
+            if (aik == 0.0) {
+                continue;
+            }
+            for (size_t j = 0; j < n; ++j) {
+                result[i * n + j] += aik * b[k * n + j];
+            }
+        }
+    }
+    return result;
+}
+
+// Matrix exponential by scaling and squaring: exp(M) = exp(M / 2^s)^(2^s), the scaled
+// exponential is a Taylor series which converges fast for a norm below 0.5
+static std::vector<double> matrixExponential(const std::vector<double>& matrix, size_t n)
+{
+    double norm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double rowSum = 0.0;
+        for (size_t j = 0; j < n; ++j) {
+            rowSum += std::abs(matrix[i * n + j]);
+        }
+        norm = std::max(norm, rowSum);
+    }
+
+    int squarings = norm > 0.5 ? static_cast<int>(std::ceil(std::log2(norm / 0.5))) : 0;
+    double scale = std::ldexp(1.0, -squarings);
+
+    std::vector<double> scaled(matrix);
+    for (double& value : scaled) {
+        value *= scale;
+    }
+
+    std::vector<double> result(n * n, 0.0);
+    std::vector<double> term(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        result[i * n + i] = 1.0;
+        term[i * n + i] = 1.0;
+    }
+
+    for (int k = 1; k <= 20; ++k) {
+        term = multiplyMatrices(term, scaled, n);
+        double termNorm = 0.0;
+        for (size_t i = 0; i < n * n; ++i) {
+            term[i] /= k;
+            result[i] += term[i];
+            termNorm = std::max(termNorm, std::abs(term[i]));
+        }
+        if (termNorm < 1e-17) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < squarings; ++i) {
+        result = multiplyMatrices(result, result, n);
+    }
+
+    return result;
+}
+
+// Characteristic polynomial det(zI - A) with the highest power first (leading 1).
+// A is reduced to upper Hessenberg form with Householder reflections, the polynomial
+// of the Hessenberg matrix follows from La Budde's recurrence.
+static std::vector<double> characteristicPolynomial(std::vector<double> a, size_t n)
+{
+    for (size_t k = 0; k + 2 < n; ++k) {
+        // Householder vector for the column below the subdiagonal
+        double alpha = 0.0;
+        for (size_t i = k + 1; i < n; ++i) {
+            alpha += a[i * n + k] * a[i * n + k];
+        }
+        alpha = std::sqrt(alpha);
+        if (alpha == 0.0) {
+            continue;
+        }
+        if (a[(k + 1) * n + k] > 0.0) {
+            alpha = -alpha;
+        }
+
+        std::vector<double> v(n, 0.0);
+        v[k + 1] = a[(k + 1) * n + k] - alpha;
+        for (size_t i = k + 2; i < n; ++i) {
+            v[i] = a[i * n + k];
+        }
+        double vNorm = 0.0;
+        for (size_t i = k + 1; i < n; ++i) {
+            vNorm += v[i] * v[i];
+        }
+        if (vNorm == 0.0) {
+            continue;
+        }
+
+        // A = H A H with H = I - 2 v v^T / (v^T v)
+        for (size_t j = 0; j < n; ++j) {
+            double dot = 0.0;
+            for (size_t i = k + 1; i < n; ++i) {
+                dot += v[i] * a[i * n + j];
+            }
+            double factor = 2.0 * dot / vNorm;
+            for (size_t i = k + 1; i < n; ++i) {
+                a[i * n + j] -= factor * v[i];
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            double dot = 0.0;
+            for (size_t j = k + 1; j < n; ++j) {
+                dot += a[i * n + j] * v[j];
+            }
+            double factor = 2.0 * dot / vNorm;
+            for (size_t j = k + 1; j < n; ++j) {
+                a[i * n + j] -= factor * v[j];
+            }
+        }
+    }
+
+    // La Budde: p[k] is the polynomial of the leading k x k block, lowest power first
+    auto h = [&](size_t row, size_t column) { return a[(row - 1) * n + (column - 1)]; };
+    std::vector<std::vector<double>> p(n + 1);
+    p[0] = { 1.0 };
+    for (size_t k = 1; k <= n; ++k) {
+        p[k].assign(k + 1, 0.0);
+        for (size_t j = 0; j < k; ++j) {
+            p[k][j + 1] += p[k - 1][j];
+            p[k][j] -= h(k, k) * p[k - 1][j];
+        }
+
+        double product = 1.0;
+        for (size_t i = 1; i < k; ++i) {
+            product *= h(k - i + 1, k - i);
+            double factor = h(k - i, k) * product;
+            for (size_t j = 0; j < p[k - i - 1].size(); ++j) {
+                p[k][j] -= factor * p[k - i - 1][j];
+            }
+        }
+    }
+
+    return std::vector<double>(p[n].rbegin(), p[n].rend());
+}
+
+// state = Ad state + input, 'next' is the buffer for the result. A null input is zero.
+static void advanceState(const std::vector<double>& ad, const double* input, std::vector<double>& state, std::vector<double>& next, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        double value = input ? input[i] : 0.0;
+        for (size_t j = 0; j < n; ++j) {
+            value += ad[i * n + j] * state[j];
+        }
+        next[i] = value;
+    }
+    state.swap(next);
+}
+
+// Removes leading zeros so the first coefficient is the highest power
+static std::vector<double> trimPolynomial(const std::vector<double>& coefficients)
+{
+    auto first = std::find_if(coefficients.begin(), coefficients.end(), [](double value) { return value != 0.0; });
+    return std::vector<double>(first, coefficients.end());
+}
+
+// Diagonal similarity D^-1 A D with powers of two (Parlett and Reinsch) so that rows and columns
+// have similar norms. The companion matrix of a high order polynomial has entries of very different
+// size, without balancing its exponential is too inaccurate. Returns the diagonal of D.
+static std::vector<double> balanceMatrix(std::vector<double>& matrix, size_t n)
+{
+    std::vector<double> scaling(n, 1.0);
+    bool converged = false;
+    for (int sweep = 0; sweep < 100 && !converged; ++sweep) {
+        converged = true;
+        for (size_t i = 0; i < n; ++i) {
+            double columnNorm = 0.0;
+            double rowNorm = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                if (j != i) {
+                    columnNorm += std::abs(matrix[j * n + i]);
+                    rowNorm += std::abs(matrix[i * n + j]);
+                }
+            }
+            if (columnNorm == 0.0 || rowNorm == 0.0) {
+                continue;
+            }
+
+            double factor = 1.0;
+            double scaledColumn = columnNorm;
+            while (scaledColumn < rowNorm / 2.0) {
+                factor *= 2.0;
+                scaledColumn *= 4.0;
+            }
+            while (scaledColumn >= rowNorm * 2.0) {
+                factor /= 2.0;
+                scaledColumn /= 4.0;
+            }
+
+            if ((scaledColumn + rowNorm) / factor < 0.95 * (columnNorm + rowNorm)) {
+                converged = false;
+                scaling[i] *= factor;
+                for (size_t j = 0; j < n; ++j) {
+                    matrix[i * n + j] /= factor;
+                    matrix[j * n + i] *= factor;
+                }
+            }
+        }
+    }
+    return scaling;
+}
+
+// TimeResponse class implementation
+TimeResponse::TimeResponse() {}
+
+double TimeResponse::chooseDuration(const TransferFunction& transferFunction) {
+    double slowestRate = 0.0;
+    double timeConstants = 0.0;
+
+    for (const auto& pole : transferFunction.getPoles()) {
+        double magnitude = std::abs(pole);
+        if (magnitude < 1e-12) {
+            continue;   // integrators do not settle
+        }
+
+        // Lightly damped poles settle slowly, the duration is limited to about 130 periods
+        double rate = std::max(std::abs(pole.real()), 0.01 * magnitude);
+        slowestRate = slowestRate == 0.0 ? rate : std::min(slowestRate, rate);
+        timeConstants += 1.0 / rate;
+    }
+
+    // Chains of similar poles delay each other, their time constants add up
+    return slowestRate > 0.0 ? std::max(8.0 / slowestRate, 2.0 * timeConstants) : 10.0;
+}
+
+void TimeResponse::compute(const TransferFunction& transferFunction) {
+    double duration = chooseDuration(transferFunction);
+
+    // About ten samples per time constant of the fastest pole
+    double fastestRate = 0.0;
+    bool stable = true;
+    for (const auto& pole : transferFunction.getPoles()) {
+        fastestRate = std::max(fastestRate, std::abs(pole));
+        stable = stable && pole.real() < 0.0;
+    }
+
+    // Final value of a stable system, G(0)
+    std::vector<double> numerator = trimPolynomial(transferFunction.getNumerator());
+    std::vector<double> denominator = trimPolynomial(transferFunction.getDenominator());
+    double finalValue = 0.0;
+    if (stable && !numerator.empty() && !denominator.empty() && denominator.back() != 0.0) {
+        finalValue = numerator.back() / denominator.back();
+    }
+
+    // The duration only follows the poles. A large jump by direct feedthrough (lead network) takes
+    // longer to decay into the 2 % band, so the simulation is repeated with twice the duration until
+    // the end lies well inside the band.
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        double samples = std::min(std::max(duration * fastestRate * 10.0, 500.0), 20000.0);
+        compute(transferFunction, duration, static_cast<size_t>(samples));
+
+        if (finalValue == 0.0 || stepValues.empty() || !std::isfinite(stepValues.back())
+            || std::abs(stepValues.back() / finalValue - 1.0) <= 0.01) {
+            break;
+        }
+        duration *= 2.0;
+    }
+}
+
+void TimeResponse::compute(const TransferFunction& transferFunction, double duration, size_t sampleCount) {
+    times.clear();
+    stepValues.clear();
+    impulseValues.clear();
+
+    std::vector<double> numerator = trimPolynomial(transferFunction.getNumerator());
+    std::vector<double> denominator = trimPolynomial(transferFunction.getDenominator());
+    if (denominator.empty() || numerator.size() > denominator.size() || denominator.size() - 1 > maxOrder
+        || sampleCount < 2 || !(duration > 0.0)) {
+        return;
+    }
+
+    const size_t n = denominator.size() - 1;
+    const double sampleTime = duration / (sampleCount - 1);
+
+    if (times.capacity() < sampleCount) {
+        Profiler::instance().addCounter("Buffer allocations", 3);
+    }
+    times.resize(sampleCount);
+    stepValues.resize(sampleCount);
+    impulseValues.resize(sampleCount);
+    Profiler::instance().addCounter("Simulated samples", static_cast<long long>(sampleCount));
+
+    for (size_t k = 0; k < sampleCount; ++k) {
+        times[k] = k * sampleTime;
+    }
+
+    // Monic denominator s^n + a1 s^(n-1) + ... + an and numerator padded to the same length
+    std::vector<double> a(n + 1);
+    std::vector<double> b(n + 1, 0.0);
+    for (size_t i = 0; i <= n; ++i) {
+        a[i] = denominator[i] / denominator[0];
+    }
+    for (size_t i = 0; i < numerator.size(); ++i) {
+        b[n + 1 - numerator.size() + i] = numerator[i] / denominator[0];
+    }
+
+    // Static gain only, the Dirac part of the impulse response can not be sampled
+    const double d = b[0];
+    if (n == 0) {
+        std::fill(stepValues.begin(), stepValues.end(), d);
+        std::fill(impulseValues.begin(), impulseValues.end(), 0.0);
+        return;
+    }
+
+    // Controllable companion form: first row -a1 ... -an, ones below the diagonal, B = e1.
+    // It is balanced to D^-1 A D, then B becomes D^-1 e1 and C becomes C D.
+    std::vector<double> system(n * n, 0.0);
+    for (size_t j = 0; j < n; ++j) {
+        system[j] = -a[j + 1];
+    }
+    for (size_t i = 1; i < n; ++i) {
+        system[i * n + (i - 1)] = 1.0;
+    }
+    std::vector<double> scaling = balanceMatrix(system, n);
+
+    std::vector<double> c(n);
+    for (size_t i = 0; i < n; ++i) {
+        c[i] = (b[i + 1] - a[i + 1] * d) * scaling[i];
+    }
+
+    // exp([[A, B], [0, 0]] * T) = [[Ad, Bd], [0, 1]] is the zero order hold discretization
+    const size_t m = n + 1;
+    std::vector<double> augmented(m * m, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            augmented[i * m + j] = system[i * n + j] * sampleTime;
+        }
+    }
+    augmented[n] = sampleTime / scaling[0];
+
+    std::vector<double> exponential = matrixExponential(augmented, m);
+    std::vector<double> ad(n * n);
+    std::vector<double> bd(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            ad[i * n + j] = exponential[i * m + j];
+        }
+        bd[i] = exponential[i * m + n];
+    }
+
+    // Cayley-Hamilton: every sequence C Ad^k x follows the characteristic polynomial of Ad
+    std::vector<double> alpha = characteristicPolynomial(ad, n);
+
+    // Clustered poles make the recurrence sensitive to rounding errors, so it only runs inside
+    // windows of W samples. Every window starts from the exact state (advanced with Ad^W) and the
+    // recurrence is checked against that state at its end. A window which deviates is simulated
+    // again with the state space model and the following windows are halved.
+    size_t window = std::min(std::max(n * n, 4 * (n + 1)), sampleCount);
+    std::vector<double> windowMatrix;   // Ad^W
+    std::vector<double> windowInput;    // state after W steps of the unit step, starting from zero
+    std::vector<double> next(n);
+
+    auto prepareWindow = [&](size_t length, std::vector<double>& matrix, std::vector<double>& input) {
+        matrix.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            matrix[i * n + i] = 1.0;
+        }
+        std::vector<double> power(ad);
+        for (size_t exponent = length; exponent > 0; exponent /= 2) {
+            if (exponent % 2 == 1) {
+                matrix = multiplyMatrices(matrix, power, n);
+            }
+            if (exponent > 1) {
+                power = multiplyMatrices(power, power, n);
+            }
+        }
+
+        input.assign(n, 0.0);
+        for (size_t k = 0; k < length; ++k) {
+            advanceState(ad, bd.data(), input, next, n);
+        }
+    };
+    prepareWindow(window, windowMatrix, windowInput);
+
+    std::vector<double> stepState(n, 0.0);
+    std::vector<double> impulseState(n, 0.0);
+    std::vector<double> stepCurrent(n);
+    std::vector<double> impulseCurrent(n);
+    impulseState[0] = 1.0 / scaling[0];   // x(0+) = B after a Dirac impulse
+
+    auto output = [&](const std::vector<double>& state, double feedthrough) {
+        double value = feedthrough;
+        for (size_t i = 0; i < n; ++i) {
+            value += c[i] * state[i];
+        }
+        return value;
+    };
+
+    // The step response is continued through its differences, which are samples of C Ad^k Bd
+    auto predictImpulse = [&](size_t k) {
+        double impulse = 0.0;
+        for (size_t i = 1; i <= n; ++i) {
+            impulse -= alpha[i] * impulseValues[k - i];
+        }
+        return impulse;
+    };
+    auto predictStep = [&](size_t k) {
+        double difference = 0.0;
+        for (size_t i = 1; i <= n; ++i) {
+            difference -= alpha[i] * (stepValues[k - i] - stepValues[k - i - 1]);
+        }
+        return stepValues[k - 1] + difference;
+    };
+
+    // The first 'exactSamples' samples of the window come from the state space model, the
+    // rest from the O(n) recurrence
+    auto simulateWindow = [&](size_t first, size_t last, size_t exactSamples) {
+        stepCurrent = stepState;
+        impulseCurrent = impulseState;
+        for (size_t k = first; k < last; ++k) {
+            if (k - first < exactSamples) {
+                stepValues[k] = output(stepCurrent, d);
+                impulseValues[k] = output(impulseCurrent, 0.0);
+                advanceState(ad, bd.data(), stepCurrent, next, n);
+                advanceState(ad, nullptr, impulseCurrent, next, n);
+            }
+            else {
+                impulseValues[k] = predictImpulse(k);
+                stepValues[k] = predictStep(k);
+            }
+        }
+    };
+
+    bool useRecurrence = true;
+    for (size_t first = 0; first < sampleCount;) {
+        const size_t last = std::min(first + window, sampleCount);
+        const bool recurrenceUsed = useRecurrence && last - first > n + 1;
+        simulateWindow(first, last, recurrenceUsed ? n + 1 : last - first);
+        if (last == sampleCount && !recurrenceUsed) {
+            break;
+        }
+
+        // The last window is usually shorter, it is checked with its own power of Ad
+        if (last - first != window) {
+            prepareWindow(last - first, windowMatrix, windowInput);
+        }
+
+        // Exact state at the start of the next window, the previous one is kept for a repetition
+        stepCurrent = stepState;
+        impulseCurrent = impulseState;
+        for (size_t i = 0; i < n; ++i) {
+            double step = windowInput[i];
+            double impulse = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                step += windowMatrix[i * n + j] * stepCurrent[j];
+                impulse += windowMatrix[i * n + j] * impulseCurrent[j];
+            }
+            stepState[i] = step;
+            impulseState[i] = impulse;
+        }
+
+        if (recurrenceUsed) {
+            double stepExact = output(stepState, d);
+            double impulseExact = output(impulseState, 0.0);
+            double stepScale = std::abs(stepExact);
+            double impulseScale = std::abs(impulseExact);
+            // Only exact samples set the scale, a diverging recurrence would hide itself
+            for (size_t k = first; k < first + n + 1; ++k) {
+                stepScale = std::max(stepScale, std::abs(stepValues[k]));
+                impulseScale = std::max(impulseScale, std::abs(impulseValues[k]));
+            }
+
+            // Written as !(error <= tolerance) so an overflowed (inf or NaN) recurrence fails as well
+            if (!(std::abs(predictStep(last) - stepExact) <= 1e-9 * stepScale)
+                || !(std::abs(predictImpulse(last) - impulseExact) <= 1e-9 * impulseScale)) {
+                std::vector<double> checkpointStep(stepState);
+                std::vector<double> checkpointImpulse(impulseState);
+                stepState = stepCurrent;
+                impulseState = impulseCurrent;
+                simulateWindow(first, last, last - first);
+                stepState.swap(checkpointStep);
+                impulseState.swap(checkpointImpulse);
+
+                if (window / 2 >= 2 * (n + 1)) {
+                    window /= 2;
+                    prepareWindow(window, windowMatrix, windowInput);
+                }
+                else {
+                    useRecurrence = false;
+                }
+            }
+        }
+
+        first = last;
+    }
+}
+
+std::vector<TimeResponse> TimeResponse::computeBatch(const std::vector<const TransferFunction*>& transferFunctions) {
+    std::vector<TimeResponse> results(transferFunctions.size());
+
+    parallelFor(transferFunctions.size(), [&](size_t system) {
+        results[system].compute(*transferFunctions[system]);
+        });
+
+    return results;
+}
+
+const std::vector<double>& TimeResponse::getTimes() const {
+    return times;
+}
+
+const std::vector<double>& TimeResponse::getStepValues() const {
+    return stepValues;
+}
+
+const std::vector<double>& TimeResponse::getImpulseValues() const {
+    return impulseValues;
+}
+
+// StepAnalyzer class implementation
+StepAnalyzer::StepAnalyzer()
+    : steadyStateValue("-"), overshoot("-"), riseTime("-"), settlingTime("-"), peakTime("-") {}
+
+void StepAnalyzer::analyze(const TransferFunction& transferFunction, const TimeResponse& timeResponse) {
+    const auto& times = timeResponse.getTimes();
+    const auto& values = timeResponse.getStepValues();
+    if (values.empty()) {
+        return;
+    }
+
+    // An overflowed simulation gives no meaningful metrics
+    for (double value : values) {
+        if (!std::isfinite(value)) {
+            return;
+        }
+    }
+
+    // Only stable systems have a steady state
+    for (const auto& pole : transferFunction.getPoles()) {
+        if (pole.real() >= 0.0) {
+            return;
+        }
+    }
+
+    std::vector<double> numerator = trimPolynomial(transferFunction.getNumerator());
+    std::vector<double> denominator = trimPolynomial(transferFunction.getDenominator());
+    if (numerator.empty() || denominator.empty() || denominator.back() == 0.0) {
+        return;
+    }
+
+    // Final value theorem: y(inf) = G(0)
+    const double finalValue = numerator.back() / denominator.back();
+    steadyStateValue = std::to_string(finalValue);
+    if (finalValue == 0.0) {
+        return;
+    }
+
+    // Work on the transition from the initial value (direct feedthrough jumps there at t = 0)
+    // to the final value, so negative gains and lead networks are handled the same way
+    const double initialValue = values[0];
+    const double transition = finalValue - initialValue;
+    if (std::abs(transition) > 1e-9 * std::abs(finalValue)) {
+        auto normalized = [&](size_t i) {
+            return (values[i] - initialValue) / transition;
+        };
+
+        size_t peakIndex = 0;
+        double peak = normalized(0);
+        for (size_t i = 1; i < values.size(); ++i) {
+            if (normalized(i) > peak) {
+                peak = normalized(i);
+                peakIndex = i;
+            }
+        }
+        overshoot = std::to_string(std::max(0.0, (peak - 1.0) * 100.0));
+
+        // A maximum at the end of the simulation is no peak (monotone response)
+        if (peakIndex > 0 && peakIndex + 1 < values.size()) {
+            peakTime = std::to_string(times[peakIndex]);
+        }
+
+        // Time of the first crossing of 'level', linear interpolation between the samples
+        auto crossingTime = [&](double level) {
+            for (size_t i = 1; i < values.size(); ++i) {
+                double previous = normalized(i - 1);
+                double current = normalized(i);
+                if (previous < level && current >= level) {
+                    return times[i - 1] + (level - previous) / (current - previous) * (times[i] - times[i - 1]);
+                }
+            }
+            return -1.0;
+        };
+
+        double riseStart = crossingTime(0.1);
+        double riseEnd = crossingTime(0.9);
+        if (riseStart >= 0.0 && riseEnd >= 0.0) {
+            riseTime = std::to_string(riseEnd - riseStart);
+        }
+    }
+
+    // Last sample outside the 2 % band, the response must be inside at the end of the simulation
+    size_t lastOutside = values.size();
+    for (size_t i = values.size(); i-- > 0;) {
+        if (std::abs(values[i] / finalValue - 1.0) > 0.02) {
+            lastOutside = i;
+            break;
+        }
+    }
+    if (lastOutside == values.size()) {
+        settlingTime = std::to_string(times[0]);
+    }
+    else if (lastOutside + 1 < values.size()) {
+        settlingTime = std::to_string(times[lastOutside + 1]);
+    }
+}
+
+std::string StepAnalyzer::getSteadyStateValue() const {
+    return steadyStateValue;
+}
+
+std::string StepAnalyzer::getOvershoot() const {
+    return overshoot;
+}
+
+std::string StepAnalyzer::getRiseTime() const {
+    return riseTime;
+}
+
+std::string StepAnalyzer::getSettlingTime() const {
+    return settlingTime;
+}
+
+std::string StepAnalyzer::getPeakTime() const {
+    return peakTime;
+}
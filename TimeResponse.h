@@ -0,0 +1,70 @@
+#ifndef TIMERESPONSE_H
+#define TIMERESPONSE_H
+
+#include "FunctionalClasses.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// TimeResponse class
+// Step and impulse response of a transfer function. The transfer function is converted into
+// controllable companion form and discretized once with the matrix exponential (exact for a
+// step input). The output is then continued with the characteristic polynomial of the discrete
+// system matrix, which costs O(n) per sample. Windows of the recurrence are checked against the
+// exact state and simulated with the state space model where rounding errors grow (clustered poles).
+// The companion matrix is balanced before the discretization.
+class TimeResponse {
+private:
+    std::vector<double> times;
+    std::vector<double> stepValues;
+    std::vector<double> impulseValues;
+
+public:
+    TimeResponse();
+
+    // Above this order the expanded coefficients no longer determine the poles accurately enough,
+    // the simulated response would diverge even for a stable system
+    static constexpr size_t maxOrder = 40;
+
+    // Chooses duration and sample count from the poles and simulates the system. A stable system
+    // that has not settled at the end is simulated again with up to 16 times the duration.
+    // Improper transfer functions (numerator order > denominator order) and denominators above
+    // maxOrder give an empty response.
+    void compute(const TransferFunction& transferFunction);
+    void compute(const TransferFunction& transferFunction, double duration, size_t sampleCount);
+
+    // Simulates several systems in parallel, each with its own time axis
+    static std::vector<TimeResponse> computeBatch(const std::vector<const TransferFunction*>& transferFunctions);
+
+    // Simulation time which shows the settling of the slowest pole
+    static double chooseDuration(const TransferFunction& transferFunction);
+
+    const std::vector<double>& getTimes() const;
+    const std::vector<double>& getStepValues() const;
+    const std::vector<double>& getImpulseValues() const;
+};
+
+// StepAnalyzer class
+// Standard metrics of the step response. Values that can not be determined (unstable system,
+// not settled within the simulated time, no transition between initial and final value) stay "-".
+class StepAnalyzer {
+private:
+    std::string steadyStateValue;
+    std::string overshoot;         // percent of the transition from the initial to the steady state value
+    std::string riseTime;          // 10 % to 90 % of that transition
+    std::string settlingTime;      // stays within 2 % of the steady state value
+    std::string peakTime;          // "-" for responses without an interior maximum
+
+public:
+    StepAnalyzer();
+
+    void analyze(const TransferFunction& transferFunction, const TimeResponse& timeResponse);
+
+    std::string getSteadyStateValue() const;
+    std::string getOvershoot() const;
+    std::string getRiseTime() const;
+    std::string getSettlingTime() const;
+    std::string getPeakTime() const;
+};
+
+#endif // TIMERESPONSE_H
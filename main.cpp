@@ -1,11 +1,20 @@
 #include "AppBodeDiagramm.h"
 #include <QtWidgets/QApplication>
 #include "Orchestrator.h"
+#include <string>
 
 int main(int argc, char* argv[])
 {
     QApplication a(argc, argv);
 
+    // Optional: --trace <file> writes the pipeline timings of the whole session as Chrome trace when the app closes
+    std::string traceFilePath;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--trace") {
+            traceFilePath = argv[i + 1];
+        }
+    }
+
     // Instantiate the Orchestrator
     Orchestrator* orchestrator = new Orchestrator();
 
@@ -19,5 +28,11 @@ int main(int argc, char* argv[])
     // Initial Creating the Plots so they are not empty.
     orchestrator->updateRecognizedFunction();
 
-    return a.exec();
+    int result = a.exec();
+
+    if (!traceFilePath.empty()) {
+        orchestrator->exportTimingTrace(traceFilePath);
+    }
+
+    return result;
 }